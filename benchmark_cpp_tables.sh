@@ -0,0 +1,259 @@
+#!/usr/bin/env bash
+# benchmark_cpp_tables.sh - 比较 C++17 编译期特化的解析器与 C 解析器的解析速度
+#
+# 同一个文法分别生成 C++ constexpr 分析表 (--cpp)、二进制分析表 (-b) 与 C 解析器，
+# 在同一段随机生成的词法值序列上计时，并比较三者计算出的结果。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_cpp_tables_bench"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+cd "$build_dir"
+
+echo "=== C++ 分析表基准测试 ==="
+echo ""
+
+cat > calc.y << 'EOF'
+%{
+long checksum;
+void yyerror(const char* s);
+int yylex(void);
+%}
+%union {
+    int ival;
+}
+%token <ival> NUM
+%type <ival> expr
+%left '+' '-'
+%left '*' '/'
+%start input
+%%
+input : input stmt
+      | stmt
+      ;
+stmt : expr ';' { checksum += $1; }
+     ;
+expr : expr '+' expr { $$ = $1 + $3; }
+     | expr '-' expr { $$ = $1 - $3; }
+     | expr '*' expr { $$ = $1 * $3; }
+     | expr '/' expr { $$ = $3 ? $1 / $3 : 0; }
+     | '(' expr ')' { $$ = $2; }
+     | NUM
+     ;
+%%
+EOF
+
+# 三个解析器共用的输入: 随机表达式语句组成的词法值序列
+cat > stream.h << 'EOF'
+#include <stdlib.h>
+#include <time.h>
+
+enum { STATEMENTS = 200000, ROUNDS = 10 };
+
+static int* stream_tokens;
+static int* stream_values;
+static int stream_length;
+static int stream_pos;
+
+static void stream_emit(int token, int value)
+{
+    stream_tokens[stream_length] = token;
+    stream_values[stream_length] = value;
+    stream_length++;
+}
+
+static void stream_expr(int depth)
+{
+    int terms = 1 + rand() % 4;
+    for (int i = 0; i < terms; i++) {
+        if (i > 0) {
+            stream_emit("+-*/"[rand() % 4], 0);
+        }
+        if (depth < 3 && rand() % 4 == 0) {
+            stream_emit('(', 0);
+            stream_expr(depth + 1);
+            stream_emit(')', 0);
+        } else {
+            stream_emit(NUM_TOKEN, 1 + rand() % 100);
+        }
+    }
+}
+
+static void stream_build(void)
+{
+    stream_tokens = (int*)malloc(sizeof(int) * STATEMENTS * 64);
+    stream_values = (int*)malloc(sizeof(int) * STATEMENTS * 64);
+    srand(1);
+    for (int i = 0; i < STATEMENTS; i++) {
+        stream_expr(0);
+        stream_emit(';', 0);
+    }
+    stream_emit(0, 0);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+EOF
+
+# 生成的 C 解析器：逐步打印跟踪信息，计时时将 stdout 重定向到 /dev/null
+cat > bench_generated.c << 'EOF'
+#include <stdio.h>
+#include <unistd.h>
+#include "calc.tab.h"
+#define NUM_TOKEN NUM
+#include "stream.h"
+
+char* yytext = "";
+int yylineno = 1;
+extern long checksum;
+void yyerror(const char* s) { (void)s; }
+
+int yylex(void)
+{
+    yylval.ival = stream_values[stream_pos];
+    return stream_tokens[stream_pos++];
+}
+
+int main(void)
+{
+    stream_build();
+    FILE* report = fdopen(dup(fileno(stdout)), "w");
+    freopen("/dev/null", "w", stdout);
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        stream_pos = 0;
+        if (yyparse() != 0) {
+            fprintf(report, "解析失败\n");
+            return 1;
+        }
+    }
+    double elapsed = now_ns() - start;
+    fprintf(report, "生成的 C 解析器 (含跟踪输出): %7.2f ns/词法值, checksum %ld\n",
+        elapsed / ((double)stream_length * ROUNDS), checksum);
+    return 0;
+}
+EOF
+
+# 通用 C 驱动：加载二进制分析表
+cat > bench_runtime.c << 'EOF'
+#include <stdio.h>
+#include "calc.tab.h"
+#include "seuyacc_runtime.h"
+#define NUM_TOKEN NUM
+#include "stream.h"
+
+static long checksum;
+
+static int lex(void* user, void* value)
+{
+    (void)user;
+    *(int*)value = stream_values[stream_pos];
+    return stream_tokens[stream_pos++];
+}
+
+static int action(void* user, int rule, void* result, void* values, int length)
+{
+    int* v = (int*)values - 1;
+    int* r = result;
+    (void)user;
+    (void)length;
+    switch (rule) {
+    case 3: checksum += v[1]; break;
+    case 4: *r = v[1] + v[3]; break;
+    case 5: *r = v[1] - v[3]; break;
+    case 6: *r = v[1] * v[3]; break;
+    case 7: *r = v[3] ? v[1] / v[3] : 0; break;
+    case 8: *r = v[2]; break;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    seuyacc_tables* tables;
+    seuyacc_callbacks callbacks = { sizeof(int), NULL, lex, action, NULL };
+    if (seuyacc_tables_open("calc.tables", &tables) != SEUYACC_TABLES_OK) {
+        printf("无法加载 calc.tables\n");
+        return 1;
+    }
+    stream_build();
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        stream_pos = 0;
+        if (seuyacc_parse(tables, &callbacks) != SEUYACC_PARSE_ACCEPT) {
+            printf("解析失败\n");
+            return 1;
+        }
+    }
+    double elapsed = now_ns() - start;
+    printf("通用 C 驱动 (二进制分析表):  %7.2f ns/词法值, checksum %ld\n",
+        elapsed / ((double)stream_length * ROUNDS), checksum);
+    seuyacc_tables_close(tables);
+    return 0;
+}
+EOF
+
+# C++ 驱动：constexpr 分析表，语义动作在编译期内联
+cat > bench_cpp.cpp << 'EOF'
+#include <cstdio>
+#include "calc.tab.hpp"
+#define NUM_TOKEN calc::token::NUM
+#include "stream.h"
+
+int main()
+{
+    stream_build();
+    calc::parser<int> parser;
+    long checksum = 0;
+    auto lex = [](int& value) {
+        value = stream_values[stream_pos];
+        return stream_tokens[stream_pos++];
+    };
+    auto action = [&checksum](int rule, int& result, int* values, int) {
+        const int* v = values - 1;
+        switch (rule) {
+        case 3: checksum += v[1]; break;
+        case 4: result = v[1] + v[3]; break;
+        case 5: result = v[1] - v[3]; break;
+        case 6: result = v[1] * v[3]; break;
+        case 7: result = v[3] ? v[1] / v[3] : 0; break;
+        case 8: result = v[2]; break;
+        }
+        return 0;
+    };
+
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        stream_pos = 0;
+        if (parser.parse(lex, action) != seuyacc::parse_accept) {
+            std::printf("解析失败\n");
+            return 1;
+        }
+    }
+    double elapsed = now_ns() - start;
+    std::printf("C++ 编译期特化的解析器:      %7.2f ns/词法值, checksum %ld\n",
+        elapsed / ((double)stream_length * ROUNDS), checksum);
+    std::printf("状态栈元素: %zu 字节\n", sizeof(calc::parser<int>::state_type));
+    return 0;
+}
+EOF
+
+"$seuyacc" --definitions --binary-tables --cpp calc.y > seuyacc.log 2>&1 || { cat seuyacc.log; exit 1; }
+includes="-I. -I$root_dir/include -I$root_dir/runtime"
+cc -O2 -w $includes calc.tab.c bench_generated.c -o bench_generated
+cc -O2 -w $includes bench_runtime.c "$root_dir/runtime/seuyacc_runtime.c" -o bench_runtime
+c++ -std=c++17 -O2 -w $includes bench_cpp.cpp -o bench_cpp
+
+./bench_cpp
+./bench_runtime
+./bench_generated
+echo ""
+echo "构建目录: $build_dir"
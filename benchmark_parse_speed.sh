@@ -0,0 +1,102 @@
+#!/usr/bin/env bash
+# benchmark_parse_speed.sh - 测量生成的 c99 解析器每秒处理的 token 数
+#
+# 先用 lex 生成的词法分析器把输入（examples/c99.c 重复若干份）全部切分成 token，
+# 再反复调用 yyparse 重放同一个 token 序列，只统计语法分析本身的时间。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_parse_speed_bench"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+copies=${COPIES:-500}
+repeats=${REPEATS:-20}
+
+if ! command -v lex &> /dev/null; then
+    echo "未找到 lex，无法编译 c99 的词法分析器"
+    exit 1
+fi
+
+cd "$build_dir"
+cp "$root_dir/examples/c99.y" "$root_dir/examples/c99.l" .
+# 生成的 yyparse 中声明了 extern char* yytext，去掉文法中与之冲突的数组声明
+sed -i 's/^extern char yytext\[\];//' c99.y
+
+for ((i = 0; i < copies; i++)); do
+    cat "$root_dir/examples/c99.c"
+    echo
+done > input.c
+
+cat > replay.c << 'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "c99.tab.h"
+
+int lex_token(void);
+int yyparse(void);
+
+static int* tokens;
+static YYSTYPE* values;
+static int token_count;
+static int position;
+
+/* 按顺序返回预先切分好的 token */
+int yylex(void)
+{
+    yylval = values[position];
+    return tokens[position++];
+}
+
+int main(int argc, char** argv)
+{
+    int repeats = argc > 1 ? atoi(argv[1]) : 20;
+    int capacity = 1 << 16;
+    tokens = malloc(capacity * sizeof(int));
+    values = malloc(capacity * sizeof(YYSTYPE));
+    for (;;) {
+        if (token_count == capacity) {
+            capacity *= 2;
+            tokens = realloc(tokens, capacity * sizeof(int));
+            values = realloc(values, capacity * sizeof(YYSTYPE));
+        }
+        int token = lex_token();
+        values[token_count] = yylval;
+        tokens[token_count++] = token;
+        if (token == 0) {
+            break;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < repeats; i++) {
+        position = 0;
+        if (yyparse() != 0) {
+            printf("解析失败\n");
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%d 个 token x %d 次: %.3f 秒, %.2f M token/秒\n", token_count, repeats, seconds,
+        (double) token_count * repeats / seconds / 1e6);
+    return 0;
+}
+EOF
+
+"$seuyacc" --definitions c99.y > seuyacc.log 2>&1
+lex -o lex.yy.c c99.l
+cc -w -O2 -I. -Dmain=grammar_main -c c99.tab.c -o c99.tab.o
+cc -w -O2 -I. -Dyylex=lex_token -c lex.yy.c -o lex.yy.o
+cc -w -O2 -I. -c replay.c -o replay.o
+cc c99.tab.o lex.yy.o replay.o -o replay -ll 2> /dev/null || cc c99.tab.o lex.yy.o replay.o -o replay -lfl 2> /dev/null || \
+    cc c99.tab.o lex.yy.o replay.o -o replay
+
+echo "=== c99 解析速度 ==="
+./replay "$repeats" < input.c
+echo "构建目录: $build_dir"
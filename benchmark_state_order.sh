@@ -0,0 +1,240 @@
+#!/usr/bin/env bash
+# benchmark_state_order.sh - 比较不同状态编号顺序下 c99 解析器访问分析表的缓存缺失
+#
+# 先用插桩解析器 (-DYYPROFILE) 在训练输入上统计各状态的访问次数，
+# 再按 canonical/bfs/dfs/profile 四种顺序生成分析表，重放同样的解析过程，
+# 把每次查表访问的地址送入组相联 LRU 缓存模拟器，统计访问到的缓存行数与缺失次数。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_state_order_bench"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+orders=(canonical bfs dfs profile)
+modes=(comb dense)
+
+if ! command -v lex &> /dev/null; then
+    echo "未找到 lex，无法编译 c99 的词法分析器"
+    exit 1
+fi
+
+cd "$build_dir"
+cp "$root_dir/examples/c99.y" "$root_dir/examples/c99.l" .
+# 生成的 yyparse 中声明了 extern char* yytext，去掉文法中与之冲突的数组声明
+sed -i 's/^extern char yytext\[\];//' c99.y
+
+# 训练输入与另外几个 c99 能接受的示例
+cp "$root_dir/examples/c99.c" train.c
+cat "$root_dir"/examples/{fibonacci,array_access,array_param,no_param,test}.c > heldout.c
+
+link_parser() {
+    cc -w -O1 -I. "$@" -ll 2> /dev/null || cc -w -O1 -I. "$@" -lfl 2> /dev/null || cc -w -O1 -I. "$@"
+}
+
+echo "=== 状态编号顺序基准测试 ==="
+echo ""
+
+echo "步骤 1: 用插桩解析器统计状态的访问次数..."
+mkdir -p profile_run
+(
+    cd profile_run
+    cp ../c99.y ../c99.l .
+    "$seuyacc" --definitions c99.y > seuyacc.log 2>&1
+    lex -o lex.yy.c c99.l
+    link_parser -DYYPROFILE='"../c99.profile"' c99.tab.c lex.yy.c -o parser
+    ./parser < ../train.c > /dev/null 2>&1 || true
+)
+echo "已访问的状态: $(grep -vc '^#' c99.profile) 个"
+echo ""
+
+# 重放解析过程并模拟缓存，只访问分析表，不执行语义动作
+cat > replay.c << 'EOF'
+#include <stdio.h>
+#include <stdint.h>
+
+#define LINE_BYTES 64
+
+typedef struct cache {
+    const char* name;
+    int sets;
+    int ways;
+    uintptr_t tags[512][8];
+    long misses;
+} cache;
+
+static cache small = { "4KB/8路", 8, 8 };
+static cache large = { "32KB/8路", 64, 8 };
+static uintptr_t touched_lines[1 << 16];
+static int touched_count;
+static long accesses;
+
+static void cache_access(cache* c, uintptr_t line)
+{
+    uintptr_t* set = c->tags[line % c->sets];
+    for (int i = 0; i < c->ways; i++) {
+        if (set[i] == line + 1) {
+            for (; i > 0; i--) {
+                set[i] = set[i - 1];
+            }
+            set[0] = line + 1;
+            return;
+        }
+    }
+    c->misses++;
+    for (int i = c->ways - 1; i > 0; i--) {
+        set[i] = set[i - 1];
+    }
+    set[0] = line + 1;
+}
+
+static void touch(const void* address)
+{
+    uintptr_t line = (uintptr_t)address / LINE_BYTES;
+    accesses++;
+    cache_access(&small, line);
+    cache_access(&large, line);
+    for (int i = 0; i < touched_count; i++) {
+        if (touched_lines[i] == line) {
+            return;
+        }
+    }
+    touched_lines[touched_count++] = line;
+}
+
+static int replay(void)
+{
+    static int stack[YYMAXDEPTH];
+    int top = 0;
+    int state = 0;
+    int token = YYEMPTY;
+    stack[0] = 0;
+    for (;;) {
+        int action = YYERRACT;
+#ifdef YYPACT_NINF
+        touch(&yypact[state]);
+        if (yypact[state] == YYPACT_NINF) {
+            touch(&yydefact[state]);
+            action = -yydefact[state];
+        } else {
+            if (token == YYEMPTY) {
+                token = yytranslate_token(yylex());
+                if (token == YYUNDEF) {
+                    return 1;
+                }
+            }
+            int n = yypact[state] + token;
+            if (n >= 0 && n <= YYLAST) {
+                touch(&yycheck[n]);
+                if (yycheck[n] == token) {
+                    touch(&yytable[n]);
+                    action = yytable[n];
+                }
+            }
+            if (action == YYERRACT) {
+                touch(&yydefact[state]);
+                if (yydefact[state] != 0) {
+                    action = -yydefact[state];
+                }
+            }
+        }
+#else
+        touch(&yydefonly[state]);
+        if (yydefonly[state]) {
+            touch(&yydefact[state]);
+            action = -yydefact[state];
+        } else {
+            if (token == YYEMPTY) {
+                token = yytranslate_token(yylex());
+                if (token == YYUNDEF) {
+                    return 1;
+                }
+            }
+            touch(&yytable[state * YYNTOKENS + token]);
+            action = yytable[state * YYNTOKENS + token];
+            if (action == YYERRACT) {
+                touch(&yydefact[state]);
+                if (yydefact[state] != 0) {
+                    action = -yydefact[state];
+                }
+            }
+        }
+#endif
+        if (action == YYERRACT) {
+            return 1;
+        }
+        if (action > 0) {
+            stack[++top] = action;
+            state = action;
+            token = YYEMPTY;
+        } else if (action < 0) {
+            int rule = -action - 1;
+            touch(&yyr2[rule]);
+            touch(&yyr1[rule]);
+            top -= yyr2[rule];
+            int nonterminal = yyr1[rule] - YYNTOKENS;
+#ifdef YYPACT_NINF
+            touch(&yypgoto[nonterminal]);
+            int n = yypgoto[nonterminal] + stack[top];
+            touch(&yycheck[n]);
+            touch(&yytable[n]);
+            state = yytable[n];
+#else
+            touch(&yygoto[stack[top] * YYNNTS + nonterminal]);
+            state = yygoto[stack[top] * YYNNTS + nonterminal];
+#endif
+            stack[++top] = state;
+        } else {
+            return 0;
+        }
+    }
+}
+
+int main(void)
+{
+    if (replay() != 0) {
+        printf("解析失败\n");
+        return 1;
+    }
+    printf("%8ld %10d %12ld %12ld\n", accesses, touched_count, small.misses, large.misses);
+    return 0;
+}
+EOF
+
+echo "步骤 2: 按各种顺序生成分析表并重放解析..."
+for mode in "${modes[@]}"; do
+    for order in "${orders[@]}"; do
+        dir="$mode/$order"
+        mkdir -p "$dir"
+        cp c99.y c99.l replay.c "$dir/"
+        if [[ "$order" == "profile" ]]; then
+            order_option="--state-profile=../../c99.profile"
+        else
+            order_option="--state-order=$order"
+        fi
+        (
+            cd "$dir"
+            "$seuyacc" --definitions --tables="$mode" "$order_option" c99.y > seuyacc.log 2>&1
+            lex -o lex.yy.c c99.l
+            # replay.c 直接使用生成代码中的静态数组，因此与 c99.tab.c 放在同一个编译单元
+            { echo '#define main grammar_main'; echo '#include "c99.tab.c"'; echo '#undef main'; cat replay.c; } > replay_unit.c
+            link_parser replay_unit.c lex.yy.c -o replay
+        )
+    done
+done
+
+echo ""
+for input in train heldout; do
+    echo "输入: $input.c"
+    printf "%-6s %-10s %8s %10s %12s %12s\n" "表" "顺序" "访问" "缓存行" "缺失(4KB)" "缺失(32KB)"
+    for mode in "${modes[@]}"; do
+        for order in "${orders[@]}"; do
+            printf "%-6s %-10s " "$mode" "$order"
+            (cd "$mode/$order" && ./replay < "../../$input.c")
+        done
+    done
+    echo ""
+done
+echo "构建目录: $build_dir"
@@ -0,0 +1,74 @@
+%{
+#include <stdio.h>
+#include <stdlib.h>
+
+/* 一次解析的输入与结果，通过 yyparse_ctx 的 user 字段传给 yylex 与语义动作 */
+typedef struct calc_input {
+    const char* text;
+    int position;
+    long result;
+} calc_input;
+%}
+
+%define api.pure full
+
+%union {
+    long num;
+}
+
+%token <num> NUM
+%type <num> expr
+%left '+' '-'
+%left '*' '/'
+
+%%
+
+input
+    : expr                  { ((calc_input*) yyctx->user)->result = $1; }
+    ;
+
+expr
+    : expr '+' expr         { $$ = $1 + $3; }
+    | expr '-' expr         { $$ = $1 - $3; }
+    | expr '*' expr         { $$ = $1 * $3; }
+    | expr '/' expr         { $$ = $3 != 0 ? $1 / $3 : 0; }
+    | '(' expr ')'          { $$ = $2; }
+    | NUM                   { $$ = $1; }
+    ;
+
+%%
+
+/* 可重入的词法分析器：读取位置保存在 ctx->user 中，不使用全局变量 */
+int yylex(YYSTYPE* yylvalp, yyparse_ctx* ctx)
+{
+    calc_input* in = (calc_input*) ctx->user;
+    const char* p = in->text + in->position;
+    while (*p == ' ' || *p == '\t' || *p == '\n') {
+        if (*p == '\n') {
+            ctx->lineno++;
+        }
+        p++;
+    }
+    ctx->text = p;
+    if (*p == '\0') {
+        in->position = (int) (p - in->text);
+        return 0;
+    }
+    if (*p >= '0' && *p <= '9') {
+        long value = 0;
+        while (*p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            p++;
+        }
+        yylvalp->num = value;
+        in->position = (int) (p - in->text);
+        return NUM;
+    }
+    in->position = (int) (p + 1 - in->text);
+    return *p;
+}
+
+void yyerror(yyparse_ctx* ctx, const char* msg)
+{
+    fprintf(stderr, "行 %d: %s\n", ctx->lineno, msg);
+}
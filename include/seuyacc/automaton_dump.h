@@ -0,0 +1,44 @@
+#ifndef SEUYACC_AUTOMATON_DUMP_H
+#define SEUYACC_AUTOMATON_DUMP_H
+
+#include "grammar.h"
+#include "lr_generator.h"
+#include <ostream>
+#include <string>
+
+namespace seuyacc {
+
+// 自动机导出格式
+enum class AutomatonFormat {
+    NONE,
+    JSON_LINES, // 每行一个 JSON 对象 (.automaton.jsonl)
+    BINARY // 变长整数编码的记录流 (.automaton.bin)
+};
+
+// 解析 --dump-automaton 选项的取值 (jsonl 或 binary)，无法识别时返回false
+bool parseAutomatonFormat(const std::string& name, AutomatonFormat& format);
+// 导出文件的扩展名，如 ".automaton.jsonl"
+const char* automatonExtension(AutomatonFormat format);
+
+// 二进制格式：8 字节魔数 "SEUYAUT1" 后是一串记录，每条记录以 1 字节的记录类型开头，
+// 其后的字段都是 LEB128 编码的无符号整数，字符串为字节数加内容。
+// 记录依次为 META、各 SYMBOL、各 PRODUCTION、各 STATE、各 TRANSITION、各 CONFLICT，最后是 END。
+enum AutomatonRecord : unsigned char {
+    AUTOMATON_META = 1, // 状态数, 终结符数, 非终结符数, 产生式数
+    AUTOMATON_SYMBOL = 2, // 名字, 是否终结符（按符号编号依次出现）
+    AUTOMATON_PRODUCTION = 3, // 左部, 右部长度, 右部符号...
+    AUTOMATON_STATE = 4, // 编号, 项数, 核心项数, {产生式, 点号, 向前看数, 向前看...}, 动作数, {符号, 动作类型, 值}
+    AUTOMATON_TRANSITION = 5, // 起点, 符号, 终点
+    AUTOMATON_CONFLICT = 6, // 状态, 符号, 规约产生式, 另一动作类型, 值, 采用的动作类型, 值, 是否已解决
+    AUTOMATON_END = 7 // 状态数, 转移数, 冲突数（用于发现被截断的文件）
+};
+
+// 动作类型按 ActionType 的取值编码：0 移入, 1 规约, 2 接受, 3 错误（只出现在 %nonassoc 报错的表项与冲突中）
+
+// 按状态逐个导出自动机：符号、产生式、各状态的核心项与 ACTION 表项、全部转移和构建分析表时的冲突。
+// 状态编号与 Markdown/PlantUML 输出一致；GOTO 表即非终结符上的转移
+void writeAutomaton(std::ostream& out, const Grammar& grammar, const LRGenerator& generator, AutomatonFormat format);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_AUTOMATON_DUMP_H
@@ -0,0 +1,15 @@
+#ifndef SEUYACC_BINARY_TABLES_H
+#define SEUYACC_BINARY_TABLES_H
+
+#include "parse_tables.h"
+#include <string>
+
+namespace seuyacc {
+
+// 将分析表序列化为可直接映射使用的二进制表文件（格式见 table_format.h）
+// 分析表按行位移压缩 (comb) 编码，所有数组为本机字节序的 int32_t
+std::string serializeBinaryTables(const ParseTables& tables);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_BINARY_TABLES_H
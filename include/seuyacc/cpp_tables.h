@@ -0,0 +1,16 @@
+#ifndef SEUYACC_CPP_TABLES_H
+#define SEUYACC_CPP_TABLES_H
+
+#include "parse_tables.h"
+#include <string>
+
+namespace seuyacc {
+
+// 生成 C++17 分析表头文件 <文法名>.tab.hpp：分析表为 constexpr 数组，
+// 配合 runtime/seuyacc_parser.hpp 中的 basic_parser 模板在编译期特化解析器
+// 表按行位移压缩 (comb) 编码，每个数组按取值范围选用最窄的元素类型
+std::string generateCppTables(const ParseTables& tables, const std::string& filename);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_CPP_TABLES_H
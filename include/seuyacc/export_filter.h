@@ -0,0 +1,29 @@
+#ifndef SEUYACC_EXPORT_FILTER_H
+#define SEUYACC_EXPORT_FILTER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace seuyacc {
+
+// Markdown/PlantUML 导出时的状态筛选
+//
+// 给出状态编号或 conflicts 时只导出这些状态，再加上沿转移（正反两个方向）hops 步以内的状态；
+// 两者都未给出时导出全部状态。状态按自动机中的编号，与构建项集规范族时一致。
+struct ExportFilter {
+    std::vector<std::pair<int, int>> ranges; // 状态编号的闭区间
+    bool conflicts = false; // 加入构建ACTION表时发生冲突的状态（包括已由优先级解决的）
+    int hops = 0;
+    bool sparse = false; // 每个状态一行，只列出有动作的表项
+
+    bool selectsAll() const { return ranges.empty() && !conflicts; }
+};
+
+// 解析 "0-10,42" 形式的状态列表，失败时返回false并在error中给出原因
+bool parseStateRanges(std::string_view text, std::vector<std::pair<int, int>>& ranges, std::string& error);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_EXPORT_FILTER_H
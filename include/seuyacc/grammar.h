@@ -0,0 +1,140 @@
+#ifndef SEUYACC_GRAMMAR_H
+#define SEUYACC_GRAMMAR_H
+
+#include "symbol.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace seuyacc {
+
+class YaccParser;
+
+// 驻留化后的符号与产生式编号
+using SymbolId = std::uint32_t;
+using ProductionId = std::uint32_t;
+
+constexpr SymbolId kInvalidSymbol = static_cast<SymbolId>(-1);
+
+// 产生式右部的只读视图，指向 CSR 数组中的一段
+struct SymbolSpan {
+    const SymbolId* first = nullptr;
+    const SymbolId* last = nullptr;
+
+    const SymbolId* begin() const { return first; }
+    const SymbolId* end() const { return last; }
+    std::uint32_t size() const { return static_cast<std::uint32_t>(last - first); }
+    bool empty() const { return first == last; }
+    SymbolId operator[](std::uint32_t i) const { return first[i]; }
+};
+
+// 冻结的文法：解析完成后构建一次，由 YaccParser 与 LRGenerator 共享
+//
+// 符号编号布局:
+//   [0, terminalCount())                     终结符，0 号固定为 $
+//   [terminalCount(), augmentedStart())      非终结符，按名称排序
+//   augmentedStart()                         增广起始符号 S'
+// 产生式 0 固定为 S' -> start，其余产生式保持文法中的顺序。
+// 名称、值类型和语义动作等字符串只保存在旁表中，生成器的热路径只处理整数编号。
+class Grammar {
+public:
+    static constexpr SymbolId kEndSymbol = 0;
+
+    // 从解析结果构建冻结文法，失败时抛出 std::runtime_error
+    static std::shared_ptr<const Grammar> freeze(const YaccParser& parser);
+
+    // 符号信息
+    std::uint32_t symbolCount() const { return static_cast<std::uint32_t>(names.size()); }
+    std::uint32_t terminalCount() const { return terminal_count; }
+    std::uint32_t nonTerminalCount() const { return symbolCount() - terminal_count - 1; }
+    SymbolId augmentedStart() const { return symbolCount() - 1; }
+    SymbolId startSymbol() const { return start_symbol; }
+
+    bool isTerminal(SymbolId sym) const { return sym < terminal_count; }
+    bool isNonTerminal(SymbolId sym) const { return sym >= terminal_count; }
+    std::uint32_t nonTerminalIndex(SymbolId sym) const { return sym - terminal_count; }
+
+    ElementType kind(SymbolId sym) const { return kinds[sym]; }
+    const std::string& name(SymbolId sym) const { return names[sym]; }
+    const std::string& valueType(SymbolId sym) const { return value_types[sym]; }
+    int precedence(SymbolId sym) const { return precedences[sym]; }
+    Associativity associativity(SymbolId sym) const { return assocs[sym]; }
+
+    // 按名称查找符号，找不到时返回 kInvalidSymbol
+    SymbolId find(const std::string& name) const;
+
+    // 产生式信息
+    std::uint32_t productionCount() const { return static_cast<std::uint32_t>(lhs.size()); }
+    SymbolId left(ProductionId prod) const { return lhs[prod]; }
+    SymbolSpan right(ProductionId prod) const
+    {
+        return { rhs_symbols.data() + rhs_offsets[prod], rhs_symbols.data() + rhs_offsets[prod + 1] };
+    }
+    std::uint32_t rightLength(ProductionId prod) const { return rhs_offsets[prod + 1] - rhs_offsets[prod]; }
+    int productionPrecedence(ProductionId prod) const { return production_precedences[prod]; }
+    const std::string& semanticAction(ProductionId prod) const { return semantic_actions[prod]; }
+
+    // 以某个非终结符为左部的全部产生式
+    const ProductionId* productionsOfBegin(SymbolId nonTerminal) const
+    {
+        return productions_by_lhs.data() + lhs_offsets[nonTerminalIndex(nonTerminal)];
+    }
+    const ProductionId* productionsOfEnd(SymbolId nonTerminal) const
+    {
+        return productions_by_lhs.data() + lhs_offsets[nonTerminalIndex(nonTerminal) + 1];
+    }
+
+    // 符号与产生式结构是否相同（相同时FIRST集与项集规范族可以复用）
+    bool sameStructure(const Grammar& other) const;
+    // 优先级与结合性是否相同（结构也相同时ACTION/GOTO表可以复用）
+    bool samePrecedence(const Grammar& other) const;
+
+    // 代码段
+    const std::string& declarationCode() const { return declaration_code; }
+    const std::string& unionCode() const { return union_code; }
+    const std::string& programCode() const { return program_code; }
+
+    // %define api.pure: 生成可重入的解析器（推送式解析器总是可重入的）
+    bool pureParser() const { return pure_parser || push_parser; }
+    // %define api.push-pull: 是否生成拉取式的 yyparse 与推送式的 yypush_parse
+    bool pullParser() const { return pull_parser; }
+    bool pushParser() const { return push_parser; }
+
+private:
+    Grammar() = default;
+
+    std::uint32_t terminal_count = 0;
+    SymbolId start_symbol = kInvalidSymbol;
+
+    // 符号旁表
+    std::vector<std::string> names;
+    std::vector<std::string> value_types;
+    std::vector<ElementType> kinds;
+    std::vector<int> precedences;
+    std::vector<Associativity> assocs;
+    std::unordered_map<std::string, SymbolId> ids_by_name;
+
+    // 产生式 (CSR)
+    std::vector<SymbolId> lhs;
+    std::vector<std::uint32_t> rhs_offsets;
+    std::vector<SymbolId> rhs_symbols;
+    std::vector<int> production_precedences;
+    std::vector<std::string> semantic_actions;
+
+    // 按左部分组的产生式索引 (CSR，下标为非终结符序号)
+    std::vector<std::uint32_t> lhs_offsets;
+    std::vector<ProductionId> productions_by_lhs;
+
+    std::string declaration_code;
+    std::string union_code;
+    std::string program_code;
+    bool pure_parser = false;
+    bool pull_parser = true;
+    bool push_parser = false;
+};
+
+} // namespace seuyacc
+
+#endif // SEUYACC_GRAMMAR_H
@@ -1,12 +1,20 @@
 #ifndef SEUYACC_LR_GENERATOR_H
 #define SEUYACC_LR_GENERATOR_H
 
+#include "export_filter.h"
+#include "grammar.h"
 #include "lr_item.h"
+#include "output.h"
+#include "parse_tables.h"
 #include "parser.h"
-#include <map>
+#include "shift_reduce.h"
+#include "state_order.h"
+#include "unit_rules.h"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace seuyacc {
@@ -21,43 +29,111 @@ enum class ActionType {
 
 // 动作表项
 struct ActionEntry {
+    // ERROR 表项的 value 为 kNonassoc 时表示由 %nonassoc 产生的显式错误
+    static constexpr int kNonassoc = 1;
+
     ActionType type;
     int value; // 移入状态或规约产生式索引
 };
 
+// 构建ACTION表时遇到的冲突
+struct ConflictRecord {
+    int state;
+    SymbolId lookahead;
+    int reduce; // 表中原有的规约产生式
+    ActionEntry other; // 与之冲突的移入或另一个规约
+    ActionEntry chosen; // 最终采用的动作，ERROR 表示由 %nonassoc 报错
+    bool resolved; // 是否由优先级和结合性解决
+};
+
 // LR(1)分析表生成器
 class LRGenerator {
 public:
     // 构造函数，接收解析后的文法
     LRGenerator(const YaccParser& parser);
 
+    // 构造函数，直接共享冻结的文法
+    explicit LRGenerator(std::shared_ptr<const Grammar> grammar);
+
     // 生成LR(1)分析表
     void generateTable();
 
+    // 切换到修改后的文法并复用已构建的自动机，优先级变化时只重建ACTION/GOTO表
+    // 文法结构不同（或尚未生成分析表）时不做任何修改并返回false
+    bool rebind(std::shared_ptr<const Grammar> next);
+
+    // 导出编码后的分析表，stats 非空时返回单元规约消除的统计
+    ParseTables exportTables(UnitRuleStats* stats = nullptr) const;
+    // 导出供宿主程序按规则号回调语义动作的分析表 (-b 二进制表与 --cpp)。
+    // 单元规约是否可消除取决于 .y 中的动作文本，宿主的回调看不到，因此这里从不消除单元规约
+    ParseTables exportHostTables() const;
+
+    // 设置生成的解析器中分析表的存储方式（默认为行位移压缩）
+    void setTableMode(TableMode mode) { table_mode = mode; }
+    TableMode tableMode() const { return table_mode; }
+
+    // 设置导出分析表时状态的编号顺序，profile 为各状态（按自动机中的编号）的访问次数
+    void setStateOrder(StateOrder order, std::vector<std::uint64_t> profile = {})
+    {
+        state_order = order;
+        state_profile = std::move(profile);
+    }
+
+    int stateCount() const { return static_cast<int>(canonical_collection.size()); }
+
+    // 导出分析表时消除没有语义动作的单元规约 A -> X
+    void setEliminateUnitRules(bool enabled) { eliminate_unit_rules = enabled; }
+
+    // 生成的解析器把转到只有一个规约的状态的移入与GOTO合并为移入-规约
+    void setShiftReduce(bool enabled) { shift_reduce = enabled; }
+
+    // 设置大型输出分块格式化时可用的额外线程（为空时全部在调用线程中格式化）
+    void setOutputThreads(std::shared_ptr<ThreadBudget> budget) { output_threads = std::move(budget); }
+    ThreadBudget* outputThreads() const { return output_threads.get(); }
+
+    // 设置进度信息与冲突报告的输出流（默认为 std::cout 与 std::cerr）
+    void setOutputStreams(std::ostream& out, std::ostream& err)
+    {
+        out_stream = &out;
+        err_stream = &err;
+    }
+
     // 导出C语言头文件
     std::string generateHeaderFile(const std::string& filename = "y.tab.h") const;
+    void writeHeaderFile(std::ostream& out, const std::string& filename = "y.tab.h") const;
 
-    // 导出C语言分析器代码
-    std::string generateParserCode(const std::string& filename = "y.tab.c") const;
+    // 导出C语言分析器代码；tables_source 非空时分析表数组写入其中，作为单独编译的翻译单元
+    std::string generateParserCode(const std::string& filename = "y.tab.c", std::string* tables_source = nullptr) const;
+    // 流式导出分析器代码；tables_out 非空时分析表翻译单元写入其中
+    void writeParserCode(std::ostream& out, const std::string& filename = "y.tab.c", std::ostream* tables_out = nullptr) const;
 
     // 将自动机转换为PlantUML格式
-    std::string toPlantUML() const;
+    std::string toPlantUML(const ExportFilter& filter = ExportFilter()) const;
+    void writePlantUML(std::ostream& out, const ExportFilter& filter = ExportFilter()) const;
 
     // 将ACTION和GOTO表导出为Markdown格式
-    std::string toMarkdownTable() const;
+    std::string toMarkdownTable(const ExportFilter& filter = ExportFilter()) const;
+    void writeMarkdownTable(std::ostream& out, const ExportFilter& filter = ExportFilter()) const;
+
+    // 按筛选条件选出要导出的状态，按编号升序
+    std::vector<int> exportStates(const ExportFilter& filter) const;
+
+    // 自动机（按构建项集规范族时的编号），供导出工具逐状态读取
+    const std::vector<ItemSet>& states() const { return canonical_collection; }
+    const std::vector<StateTransition>& stateTransitions() const { return transitions; }
+    const std::vector<ActionEntry>& actionRow(int state) const { return action_table[state]; }
+    const std::vector<int>& gotoRow(int state) const { return goto_table[state]; }
+    const std::vector<ConflictRecord>& conflictRecords() const { return conflicts; }
 
 private:
+    // 导出分析表，eliminate 为 true 时消除单元规约
+    ParseTables buildTables(bool eliminate, UnitRuleStats* stats) const;
+
     // 辅助方法：将ActionEntry转换为可读字符串
     std::string actionEntryToString(const ActionEntry& entry) const;
 
-    // 辅助方法：获取所有终结符（按名称排序）
-    std::vector<Symbol> getSortedTerminals() const;
-
-    // 辅助方法：获取所有非终结符（按名称排序）
-    std::vector<Symbol> getSortedNonTerminals() const;
-
-    // 计算词法返回的原始token值
-    std::vector<int> computeRawTokenValues(const std::vector<Symbol>& terminals) const;
+    // 计算词法返回的原始token值（下标为终结符编号）
+    std::vector<int> computeRawTokenValues() const;
 
     // 解析字面量 token 的数值表示
     int parseLiteralTokenValue(const std::string& literal) const;
@@ -68,15 +144,14 @@ private:
     // 辅助方法：从Union代码中提取YYSTYPE
     std::string extractYYSTYPE() const;
 
-    // 计算文法符号的FIRST集
-    std::unordered_set<Symbol, SymbolHasher> computeFirst(const Symbol& symbol);
-    std::unordered_set<Symbol, SymbolHasher> computeFirstOfSequence(const std::vector<Symbol>& sequence);
+    // 计算所有非终结符的FIRST集与可空性
+    void computeFirstSets();
 
-    // 计算项集的闭包
-    ItemSet computeClosure(const ItemSet& itemSet);
+    // 将符号序列的FIRST集并入out，返回序列是否可推导出空串
+    bool addFirstOfSequence(const SymbolId* begin, const SymbolId* end, std::uint64_t* out) const;
 
-    // 计算GOTO函数
-    ItemSet computeGoto(const ItemSet& itemSet, const Symbol& symbol);
+    // 计算项集的闭包（items中为核心项，结果按序排列）
+    void computeClosure(ItemSet& itemSet) const;
 
     // 构建项集规范族
     void buildCanonicalCollection();
@@ -84,12 +159,17 @@ private:
     // 从项集规范族构建ACTION和GOTO表
     void buildActionGotoTable();
 
-    // 添加增广文法的起始产生式
-    void addAugmentedProduction();
+    // 右部只有一个符号且没有语义动作（或动作只是 $$ = $1）的产生式
+    bool isEliminableUnitRule(ProductionId prod) const;
 
     // 处理语义动作中的 $$ 和 $N 替换
-    std::string processSemanticAction(const std::string& action,
-        const Production& prod) const;
+    std::string processSemanticAction(const std::string& action, ProductionId prod) const;
+
+    // 按当前的表存储方式输出分析表与查表函数，definitions 非空时数组定义写入其中
+    void emitParseTables(std::ostream& ss, const ParseTables& tables, std::ostream* definitions = nullptr) const;
+
+    // 输出语法分析主循环: push 为 false 时生成调用 yylex 的 yyparse，为 true 时生成 yypush_parse
+    void writeParseFunction(std::ostream& ss, const ParseTables& tables, bool push) const;
 
     // 生成各部分代码
     std::string generateHeaderSection() const;
@@ -99,15 +179,14 @@ private:
 
     // 辅助函数：简化ACTION/GOTO构建逻辑
     bool isReduceItem(const LRItem& item) const;
-    int productionIndexOf(const LRItem& item) const;
     bool resolveReduceReduceConflict(int newProdIndex, ActionEntry& existingEntry, int& resolvedCount) const;
     bool resolveShiftReduceConflict(int stateId, const StateTransition& transition, int reduceIndex, ActionEntry& existingEntry, int& resolvedCount) const;
     void applyReduceAction(int stateId, const LRItem& item, int& conflictCount, int& resolvedCount);
     void applyShiftAction(int stateId, const StateTransition& transition, int& conflictCount, int& resolvedCount);
     void reportConflictStats(int shiftReduceConflicts, int resolvedSR, int reduceReduceConflicts, int resolvedRR) const;
 
-    // 解析后的文法
-    YaccParser parser;
+    // 冻结的文法（与解析器共享）
+    std::shared_ptr<const Grammar> grammar;
 
     // 项集规范族
     std::vector<ItemSet> canonical_collection;
@@ -115,12 +194,41 @@ private:
     // 状态转移
     std::vector<StateTransition> transitions;
 
-    // ACTION表和GOTO表
-    std::map<int, std::map<Symbol, ActionEntry>> action_table;
-    std::map<int, std::map<Symbol, int>> goto_table;
+    // ACTION表和GOTO表，按状态存放的稠密行
+    // ACTION表下标为终结符编号，ERROR 同时表示无动作；GOTO表下标为非终结符序号，-1 表示无转移
+    std::vector<std::vector<ActionEntry>> action_table;
+    std::vector<std::vector<int>> goto_table;
+
+    // 构建ACTION表时遇到的冲突（包括已由优先级解决的），按发现的顺序
+    std::vector<ConflictRecord> conflicts;
+
+    // FIRST集：每个非终结符一个终结符位集，每个位集占 terminal_words 个64位字
+    std::size_t terminal_words = 0;
+    std::vector<std::uint64_t> first_sets;
+    std::vector<bool> nullable;
+
+    // 产生式 p 的项 (p, 点号) 的编号为 item_offsets[p] + 点号
+    std::vector<std::uint32_t> item_offsets;
+
+    // 生成的解析器中分析表的存储方式
+    TableMode table_mode = TableMode::COMB;
+
+    // 导出分析表时状态的编号顺序
+    StateOrder state_order = StateOrder::CANONICAL;
+    std::vector<std::uint64_t> state_profile;
+
+    // 导出分析表时是否消除单元规约
+    bool eliminate_unit_rules = false;
+
+    // 生成的解析器是否合并移入与规约
+    bool shift_reduce = true;
+
+    // 分块格式化输出时共用的额外线程
+    std::shared_ptr<ThreadBudget> output_threads;
 
-    // 缓存FIRST集计算结果
-    std::unordered_map<Symbol, std::unordered_set<Symbol, SymbolHasher>, SymbolHasher> first_cache;
+    // 输出流，不使用全局状态以便多个生成器并发运行
+    std::ostream* out_stream = &std::cout;
+    std::ostream* err_stream = &std::cerr;
 };
 
 } // namespace seuyacc
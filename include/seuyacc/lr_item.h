@@ -1,24 +1,25 @@
 #ifndef SEUYACC_LR_ITEM_H
 #define SEUYACC_LR_ITEM_H
 
-#include "production.h"
-#include "symbol.h"
+#include "grammar.h"
+#include <cstdint>
 #include <vector>
 
 namespace seuyacc {
 
 // LR(1)项，表示 A → α·β, a 的结构
 struct LRItem {
-    Production prod; // 相关产生式
-    int dot_position; // 点号位置
-    Symbol lookahead; // 向前看符号
+    ProductionId prod; // 相关产生式编号
+    std::uint32_t dot_position; // 点号位置
+    SymbolId lookahead; // 向前看符号
 
     // 用于项集比较和存储在集合中
     bool operator==(const LRItem& other) const;
+    bool operator<(const LRItem& other) const;
     size_t hash() const;
 };
 
-// 项集，包含多个LR(1)项
+// 项集，包含多个LR(1)项（按 产生式, 点号, lookahead 排序）
 struct ItemSet {
     std::vector<LRItem> items;
     int state_id; // 状态ID，用于生成分析表
@@ -38,9 +39,9 @@ struct LRItemHasher {
 struct StateTransition {
     int from_state; // 源状态ID
     int to_state; // 目标状态ID
-    Symbol symbol; // 转移符号
+    SymbolId symbol; // 转移符号
 };
 
 } // namespace seuyacc
 
-#endif // SEUYACC_LR_ITEM_H
\ No newline at end of file
+#endif // SEUYACC_LR_ITEM_H
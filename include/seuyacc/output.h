@@ -0,0 +1,100 @@
+#ifndef SEUYACC_OUTPUT_H
+#define SEUYACC_OUTPUT_H
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace seuyacc {
+
+// 直接写文件描述符的缓冲输出文件
+//
+// 生成结果边生成边写出，内存中不保留完整的文本。内容先写入临时文件 <path>.tmp，提交时才替换目标文件，
+// 生成或写入失败时删除临时文件，目标文件保持原样。keep_unchanged 为 true 时提交前与原文件比较：
+// 内容相同则删除临时文件，保留原文件及其修改时间。
+class OutputFile : public std::ostream {
+public:
+    // commit 与 close 的结果
+    enum class Status {
+        WRITTEN,
+        UNCHANGED, // keep_unchanged 时内容与原文件相同，未重写
+        FAILED
+    };
+
+    OutputFile();
+    // 未提交的临时文件被删除
+    ~OutputFile() override;
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    // 创建临时文件，失败时返回false并在error中给出原因
+    bool open(const std::string& path, std::string& error, bool keep_unchanged = false);
+    // 写出缓冲区并关闭临时文件，失败时删除临时文件并在error中给出原因
+    bool finish(std::string& error);
+    // 用 finish 后的临时文件替换目标文件，失败时在error中给出原因
+    Status commit(std::string& error);
+    // 依次 finish 与 commit
+    Status close(std::string& error);
+    // 放弃写入，删除临时文件
+    void discard();
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        Buffer();
+
+        int fd = -1;
+        int error = 0; // 第一次写入失败时的 errno
+
+        bool flush();
+        // 丢弃缓冲区中未写出的内容并清除错误
+        void reset();
+
+    protected:
+        int_type overflow(int_type ch) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+
+    private:
+        bool writeAll(const char* data, std::size_t size);
+
+        static constexpr std::size_t kSize = 1 << 16;
+        char storage[kSize];
+    };
+
+    Buffer buffer;
+    std::string path;
+    std::string temp_path; // 实际写入的临时文件，提交或删除后为空
+    bool keep_unchanged = false;
+};
+
+// 多个 writeChunked 调用共用的额外线程数。调用线程总是自己格式化，
+// 额外的线程只在额度内启动，用完即归还；额度为 0 时全部在调用线程中完成
+class ThreadBudget {
+public:
+    explicit ThreadBudget(unsigned threads);
+
+    ThreadBudget(const ThreadBudget&) = delete;
+    ThreadBudget& operator=(const ThreadBudget&) = delete;
+
+    // 取得至多 wanted 个额度，返回实际取得的数量（可能为 0）
+    unsigned acquire(unsigned wanted);
+    void release(unsigned count);
+
+private:
+    std::mutex mutex;
+    unsigned available;
+};
+
+// 把 [0, count) 按 chunk_size 分块，调用线程与从 budget 取得的线程分别格式化各块后按顺序写入 out，
+// 同时在内存中的块数不超过线程数；只有一块或 budget 为空时直接写入 out
+void writeChunked(std::ostream& out, std::size_t count, std::size_t chunk_size,
+    const std::function<void(std::ostream& out, std::size_t begin, std::size_t end)>& format, ThreadBudget* budget);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_OUTPUT_H
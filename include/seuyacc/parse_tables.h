@@ -0,0 +1,171 @@
+#ifndef SEUYACC_PARSE_TABLES_H
+#define SEUYACC_PARSE_TABLES_H
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace seuyacc {
+
+// 编码后的分析表，与生成的解析器代码中的数组一一对应
+struct ParseTables {
+    // 错误（无动作）的编码，只在生成器内部使用，不会与任何规约编码冲突
+    // 生成的代码中换成 errorCode()，以免状态或规则很多时溢出表的元素类型
+    static constexpr int kErrorAction = std::numeric_limits<int>::min();
+
+    int state_count = 0; // YYNSTATES
+    int token_count = 0; // YYNTOKENS
+    int nonterminal_count = 0; // YYNNTS
+    int max_user_token = 0; // YYMAXUTOK
+
+    // 词法返回值 -> 终结符编号，-1 表示未定义
+    // 多字符字面量使编码稀疏时 translate 为空，所有 (词法返回值, 终结符编号) 按返回值升序存入 sparse_translate
+    std::vector<int> translate;
+    std::vector<std::pair<int, int>> sparse_translate;
+    // [状态 * token_count + 终结符]: 正数移入，负数规约 -(规则号+1)，0 接受，kErrorAction 错误
+    std::vector<int> action;
+    // 每个状态的默认规约 (yydefact): 规则号+1，0 表示没有默认规约
+    // ACTION 中的错误表项在有默认规约的状态上按默认规约处理
+    std::vector<int> default_reduction;
+    // [状态 * nonterminal_count + 非终结符序号]: 目标状态，-1 表示无转移
+    std::vector<int> goto_table;
+    // 每条产生式左部的符号编号 (yyr1) 与右部长度 (yyr2)
+    std::vector<int> rule_lhs;
+    std::vector<int> rule_length;
+    // 终结符与非终结符的名称
+    std::vector<std::string> token_names;
+    std::vector<std::string> nonterminal_names;
+    // 重新编号后每个状态在自动机中的原编号（与 Markdown/PlantUML 输出一致），为空表示未重新编号
+    std::vector<int> state_origin;
+    // 为 true 时移入与GOTO的编码 >= state_count 表示压入后立即按规则 (编码 - state_count) 规约
+    bool shift_reduce = false;
+
+    // 词法返回值对应的终结符编号，未定义时返回-1
+    int translateToken(int raw) const;
+
+    int actionAt(int state, int token) const { return action[state * token_count + token]; }
+    int gotoAt(int state, int nonterminal) const { return goto_table[state * nonterminal_count + nonterminal]; }
+
+    // 生成代码中错误的编码 (YYERRACT)：比所有规约编码 -(规则号+1) 都小
+    int errorCode() const { return -static_cast<int>(rule_length.size()) - 1; }
+
+    // 表项是否就是该状态的默认规约，这样的表项无需存入压缩表
+    bool isDefaultAction(int state, int code) const
+    {
+        return default_reduction[state] != 0 && code == -default_reduction[state];
+    }
+    // 状态除默认规约外没有其他动作，此时无需读入向前看符号即可规约
+    bool defaultOnly(int state) const;
+};
+
+// 稀疏词法值的完美哈希: 槽位为 词法值 % modulus，keys[槽位] == 词法值 时 values[槽位] 为终结符编号
+struct TranslateHash {
+    int modulus = 1;
+    std::vector<int> keys; // 空槽为 -1
+    std::vector<int> values;
+};
+
+// 为 sparse_translate 选取使所有词法值落在不同槽位的最小模数
+TranslateHash buildTranslateHash(const std::vector<std::pair<int, int>>& sparse);
+
+// 生成解析器时分析表的存储方式
+enum class TableMode {
+    DENSE, // 稠密二维数组
+    COMB, // 行位移压缩 (yypact/yypgoto + yytable/yycheck)
+    ROWS, // 相同的ACTION行只存一份 (yyrowidx)，GOTO为默认目标加例外 (yydefgoto)
+    COLOR // 图着色合并兼容的行与列，错误由位图判定（表最小，生成最慢）
+};
+
+// 解析 --tables 选项的取值，无法识别时返回false
+bool parseTableMode(const std::string& name, TableMode& mode);
+const char* tableModeName(TableMode mode);
+
+// 行位移（comb vector）压缩后的分析表，编码方式与 bison 相同：
+//   ACTION: n = pact[状态] + 终结符，check[n] == 终结符 时 table[n] 为动作，否则为错误（或默认规约）
+//   GOTO:   n = pgoto[非终结符] + 状态，check[n] == 状态 时 table[n] 为目标状态，否则无转移
+// 所有ACTION行与GOTO列共用 table/check，用首次适配 (first-fit) 依次放入，
+// 内容相同的向量共用同一个基址。
+struct CombTables {
+    int base_ninf = 0; // 没有任何表项的行/列的基址 (YYPACT_NINF)
+    std::vector<int> pact; // 每个状态ACTION行的基址
+    std::vector<int> pgoto; // 每个非终结符GOTO列的基址
+    std::vector<int> table; // 压缩后的表项
+    std::vector<int> check; // 表项所属的列号（终结符或状态），-1 表示空槽
+
+    int action(int state, int token) const;
+    int gotoState(int state, int nonterminal) const;
+};
+
+// 行共享压缩后的分析表：
+//   ACTION: 状态经 row_index 映射到去重后的行，rows[行号 * token_count + 终结符] 为动作，
+//           默认规约的表项记为错误，由 default_reduction 处理；第0行固定为空行
+//   GOTO:   每个非终结符取出现最多的目标状态作为默认值，其余表项按状态升序存为例外，
+//           goto_offsets[非终结符] 到 goto_offsets[非终结符 + 1] 为该列的例外
+struct RowTables {
+    int token_count = 0;
+    std::vector<int> row_index; // 每个状态的ACTION行号
+    std::vector<int> rows; // 去重后的ACTION行
+    std::vector<int> default_goto; // 每个非终结符的默认目标状态 (yydefgoto)，-1 表示无转移
+    std::vector<int> goto_offsets;
+    std::vector<int> goto_states; // 例外所在的状态
+    std::vector<int> goto_targets; // 例外的目标状态
+
+    int rowCount() const { return token_count == 0 ? 0 : static_cast<int>(rows.size()) / token_count; }
+    int action(int state, int token) const { return rows[row_index[state] * token_count + token]; }
+    int gotoState(int state, int nonterminal) const;
+};
+
+// 图着色压缩后的分析表 (Dencker, Dürre, Heuft)：
+//   错误与默认规约都是无关项，同一位置上没有不同有效表项的行（列）可以合并为一类，
+//   ACTION 的有效表项为 action_matrix[行类 * action_columns + 列类]；
+//   位图记录每个状态哪些终结符有有效表项，位为0时为错误（或默认规约），
+//   相同的位图行只存一份，第0行固定为全0。GOTO 中的无转移同样是无关项。
+struct ColorTables {
+    int action_columns = 0; // ACTION 列类的数量
+    std::vector<int> action_row_class; // 每个状态的行类
+    std::vector<int> action_column_class; // 每个终结符的列类
+    std::vector<int> action_matrix;
+
+    int bitmap_bytes = 0; // 每个位图行的字节数
+    std::vector<int> bitmap_row; // 每个状态的位图行号
+    std::vector<unsigned char> bitmaps;
+
+    int goto_columns = 0; // GOTO 列类的数量
+    std::vector<int> goto_row_class; // 每个状态的行类
+    std::vector<int> goto_column_class; // 每个非终结符的列类
+    std::vector<int> goto_matrix;
+
+    bool significant(int state, int token) const
+    {
+        return (bitmaps[bitmap_row[state] * bitmap_bytes + token / 8] >> (token % 8) & 1) != 0;
+    }
+    int action(int state, int token) const;
+    int gotoState(int state, int nonterminal) const;
+};
+
+// 将稠密分析表压缩为行位移形式
+CombTables compressComb(const ParseTables& dense);
+
+// 逐项比较压缩表与稠密表的解码结果，不一致时在 error 中说明第一处差异
+// 稠密表中的错误表项在有默认规约的状态上允许解码为默认规约
+bool verifyCombTables(const ParseTables& dense, const CombTables& comb, std::string& error);
+
+// 合并相同的ACTION行，并把GOTO列压缩为默认目标加例外
+RowTables compressRows(const ParseTables& dense);
+
+// 逐项比较行共享表与稠密表的解码结果，GOTO 中的无转移允许解码为默认目标
+bool verifyRowTables(const ParseTables& dense, const RowTables& rows, std::string& error);
+
+// 用图着色合并ACTION与GOTO表中兼容的行和列
+ColorTables compressColor(const ParseTables& dense);
+
+// 逐项比较图着色压缩表与稠密表的解码结果
+bool verifyColorTables(const ParseTables& dense, const ColorTables& color, std::string& error);
+
+// 按存储方式压缩并校验分析表（以及稀疏词法值的翻译哈希表），稠密表无需校验
+bool verifyTables(const ParseTables& dense, TableMode mode, std::string& error);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_PARSE_TABLES_H
@@ -1,9 +1,14 @@
 #ifndef SEUYACC_PARSER_H
 #define SEUYACC_PARSER_H
 
+#include "grammar.h"
 #include "production.h"
+#include "scanner.h"
 #include "symbol.h"
+#include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -37,9 +42,19 @@ public:
     // 程序部分的代码
     std::string program_code;
 
-    // 解析Yacc文件的方法
+    // %define api.pure: 生成可重入的解析器
+    bool pure_parser = false;
+
+    // %define api.push-pull: 生成拉取式 (yyparse) 与/或推送式 (yypush_parse) 接口
+    bool pull_parser = true;
+    bool push_parser = false;
+
+    // 解析Yacc文件的方法（文件以只读方式映射到内存）
     bool parseYaccFile(const std::string& filename);
 
+    // 解析内存中的文法文本，text 只需在调用期间保持有效
+    bool parseYaccSource(std::string_view text);
+
     // 打印解析结果
     void printParsedInfo() const;
 
@@ -47,34 +62,50 @@ public:
     Symbol& ensureSymbol(const std::string& name, ElementType type);
     const Symbol& getSymbol(const std::string& name) const;
 
+    // 解析成功后冻结的文法，供LR生成器共享使用
+    std::shared_ptr<const Grammar> grammar() const { return frozen_grammar; }
+
+    // 设置解析信息与诊断信息的输出流（默认为 std::cout 与 std::cerr）
+    void setOutputStreams(std::ostream& out, std::ostream& err)
+    {
+        out_stream = &out;
+        err_stream = &err;
+    }
+
 private:
     // 定义部分处理函数
-    void parseTokenSection(const std::string& line);
-    void parseStartSymbol(const std::string& line);
-    bool parseDeclarationCode(std::ifstream& file);
-    bool parseUnionCode(std::string& buffer, size_t& pos);
-    void parseTypeDeclaration(const std::string& line);
-    void parseAssociativity(const std::string& line, Associativity assoc);
+    bool parseDefinitionsSection(bool& found_rules);
+    void parseTokenSection();
+    void parseStartSymbol();
+    bool parseDeclarationCode();
+    bool parseUnionCode();
+    void parseTypeDeclaration();
+    void parseAssociativity(Associativity assoc);
+    bool parseDefine(const SourceLocation& location);
 
     // 规则部分按字符处理的函数
-    bool parseRulesSection(std::ifstream& file);
-    bool parseRule(std::string& buffer, size_t& pos);
-    bool parseRuleName(std::string& buffer, size_t& pos, std::string& rule_name);
-    bool parseProductions(std::string& buffer, size_t& pos, const std::string& rule_name);
-    bool parseProduction(std::string& buffer, size_t& pos, const std::string& rule_name);
-    bool parseSymbol(std::string& buffer, size_t& pos, Symbol& symbol);
-    bool parseSemanticAction(std::string& buffer, size_t& pos, std::string& action);
+    bool parseRulesSection();
+    bool parseRule();
+    bool parseRuleName(std::string& rule_name);
+    bool parseProductions(const std::string& rule_name);
+    bool parseProduction(const std::string& rule_name);
+    bool parseSymbol(Symbol& symbol);
+    bool parseSemanticAction(std::string& action);
 
     // 程序部分处理函数
-    bool parseProgramSection(std::ifstream& file);
+    bool parseProgramSection();
 
     // 辅助函数
-    void skipWhitespaceAndComments(std::string& buffer, size_t& pos);
-    bool checkChar(std::string& buffer, size_t pos, char expected);
+    bool atSectionSeparator() const;
+    void reportError(const std::string& message) const;
+    void reportError(const SourceLocation& location, const std::string& message) const;
     void validateSymbols();
     void synchronizeProductionSymbols();
     const Symbol& resolveSymbol(const Symbol& symbol) const;
 
+    // 当前扫描位置
+    Scanner scanner;
+
     // 当前最大优先级
     int current_precedence;
     int next_symbol_id;
@@ -84,6 +115,13 @@ private:
 
     // 存储所有已知的非终结符
     std::unordered_map<std::string, Symbol> defined_non_terminals;
+
+    // 冻结后的文法
+    std::shared_ptr<const Grammar> frozen_grammar;
+
+    // 输出流，不使用全局状态以便多个解析器并发运行
+    std::ostream* out_stream = &std::cout;
+    std::ostream* err_stream = &std::cerr;
 };
 
 } // namespace seuyacc
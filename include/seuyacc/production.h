@@ -2,6 +2,7 @@
 #define SEUYACC_PRODUCTION_H
 
 #include "symbol.h"
+#include <string>
 #include <vector>
 
 namespace seuyacc {
@@ -13,6 +14,8 @@ struct Production {
     std::vector<Symbol> right; // 产生式右部符号列表
     std::string semantic_action; // 语义动作代码
     int precedence; // 产生式的优先级，用于解决冲突
+    SourceLocation location; // 产生式在文法文件中的位置
+    SourceLocation action_location; // 语义动作的位置
 
     // 构造函数，设置默认值
     Production()
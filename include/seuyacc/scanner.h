@@ -0,0 +1,67 @@
+#ifndef SEUYACC_SCANNER_H
+#define SEUYACC_SCANNER_H
+
+#include "source.h"
+#include <cstddef>
+#include <string_view>
+
+namespace seuyacc {
+
+// 文法文件的单遍字符扫描器：在输入视图上移动游标并同步维护行列号
+// 所有读取结果均为指向原始输入的 string_view，不复制文本
+class Scanner {
+public:
+    Scanner() = default;
+    explicit Scanner(std::string_view text)
+        : text(text)
+    {
+    }
+
+    bool atEnd() const { return pos >= text.size(); }
+    char peek(std::size_t ahead = 0) const { return pos + ahead < text.size() ? text[pos + ahead] : '\0'; }
+    std::size_t offset() const { return pos; }
+    SourceLocation location() const { return { line, column }; }
+
+    bool startsWith(std::string_view prefix) const { return text.compare(pos, prefix.size(), prefix) == 0; }
+    // 当前位置是否处于行首（只允许前面有空白）
+    bool atLineStart() const;
+
+    void advance();
+    void advance(std::size_t count);
+
+    std::string_view slice(std::size_t begin, std::size_t end) const { return text.substr(begin, end - begin); }
+
+    // 跳过空白（含换行）以及 // 和 /* */ 注释
+    void skipWhitespaceAndComments();
+    // 只在当前行内跳过空白和注释，停在换行符处
+    void skipInlineWhitespaceAndComments();
+    // 跳到下一行的开头
+    void skipLine();
+    // 当前行是否已无有效内容（只剩空白或注释）
+    bool atLineEnd();
+
+    // 读取标识符 [A-Za-z_][A-Za-z0-9_]*，不是标识符时返回空
+    std::string_view readIdentifier();
+    // 读取到空白为止的一个单词
+    std::string_view readWord();
+    // 读取单引号字面量（含引号），未闭合时返回false
+    bool readLiteral(std::string_view& literal);
+    // 读取 <...> 类型标签（不含尖括号），未闭合时返回false
+    bool readTag(std::string_view& tag);
+    // 读取平衡的花括号块（含花括号），正确处理字符串、字符常量与注释，未闭合时返回false
+    bool readBracedBlock(std::string_view& block);
+
+    static bool isIdentifierStart(char c);
+    static bool isIdentifierChar(char c);
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; }
+
+private:
+    std::string_view text;
+    std::size_t pos = 0;
+    std::uint32_t line = 1;
+    std::uint32_t column = 1;
+};
+
+} // namespace seuyacc
+
+#endif // SEUYACC_SCANNER_H
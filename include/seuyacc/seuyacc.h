@@ -0,0 +1,105 @@
+#ifndef SEUYACC_SEUYACC_H
+#define SEUYACC_SEUYACC_H
+
+#include "automaton_dump.h"
+#include "binary_tables.h"
+#include "cpp_tables.h"
+#include "lr_generator.h"
+#include "output.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace seuyacc {
+
+// libseuyacc 的内存接口：输入文法文本，输出分析表与生成的源码
+//
+// 整个过程不读写文件、不使用全局状态，所有诊断信息都写入返回结果，
+// 因此可以在多个线程中同时调用。
+
+// 生成选项
+struct GenerateOptions {
+    // 输出文件的基本名，生成 <base_name>.tab.h 与 <base_name>.tab.c
+    std::string base_name = "y";
+
+    bool header = true; // 生成令牌定义头文件
+    bool parser = true; // 生成解析器代码
+    bool plantuml = false; // 生成状态机的 PlantUML 图
+    bool markdown = false; // 生成 Markdown 格式的分析表
+    bool tables = true; // 导出编码后的分析表
+    bool binary_tables = false; // 生成可映射的二进制表文件 <base_name>.tables
+    bool cpp_tables = false; // 生成 C++17 constexpr 分析表头文件 <base_name>.tab.hpp
+    bool separate_tables = false; // 分析表数组单独输出到 <base_name>.tab.tables.c
+    AutomatonFormat dump_automaton = AutomatonFormat::NONE; // 导出自动机到 <base_name>.automaton.jsonl 或 .bin
+
+    TableMode table_mode = TableMode::COMB; // 生成的解析器中分析表的存储方式
+    StateOrder state_order = StateOrder::CANONICAL; // 输出分析表时状态的编号顺序
+    std::vector<StateVisit> state_profile; // PROFILE 顺序使用的剖析文件记录
+    bool eliminate_unit_rules = false; // 生成的C解析器消除没有语义动作的单元规约（二进制表与C++分析表不受影响）
+    bool shift_reduce = true; // 生成的解析器合并移入与紧随其后的规约
+    bool verify_tables = false; // 校验压缩表与稠密表逐项一致
+    ExportFilter export_filter; // PlantUML 图与 Markdown 表中导出的状态及表格格式
+
+    bool verbose = false; // 在 output 中打印文法的解析结果
+
+    // 大型输出分块格式化时可用的额外线程，可在多次调用间共享；为空时按硬件线程数
+    std::shared_ptr<ThreadBudget> output_threads;
+
+    // 非空时按文件名（如 y.tab.c）打开输出流，生成结果边生成边写入，GenerateResult 中对应的文本为空；
+    // 返回空指针表示无法创建。各输出在不同线程中写入，流由调用者拥有并在返回后关闭；
+    // 使用 OutputFile 时须在返回后调用 close（或 finish 与 commit）提交，否则析构时临时文件被删除，不产生任何输出
+    std::function<std::ostream*(const std::string& name)> open_output;
+};
+
+// 生成结果
+struct GenerateResult {
+    bool success = false;
+
+    // 进度信息与冲突报告（命令行中输出到 stdout）
+    std::string output;
+    // 错误与警告（命令行中输出到 stderr）
+    std::string diagnostics;
+
+    std::string header_name;
+    std::string parser_name;
+    std::string binary_tables_name;
+    std::string cpp_tables_name;
+    std::string tables_source_name;
+    std::string plantuml_name;
+    std::string markdown_name;
+    std::string automaton_name;
+
+    std::string header;
+    std::string parser_source;
+    std::string plantuml;
+    std::string markdown;
+    std::string binary_tables;
+    std::string cpp_tables;
+    std::string tables_source; // 单独输出时的分析表翻译单元
+    std::string automaton; // 导出的自动机（二进制格式时为原始字节）
+    ParseTables tables;
+};
+
+// 从内存中的文法文本生成解析器
+GenerateResult generate(std::string_view grammar_text, const GenerateOptions& options = GenerateOptions());
+
+// 增量生成器：保存上一次的文法、FIRST集与自动机，供常驻模式反复调用
+//
+// 文法结构（符号与产生式）不变时复用项集规范族，只有优先级变化时重建ACTION/GOTO表，
+// 只修改了语义动作或代码段时只重新生成源码。每个实例只能被一个线程使用。
+class IncrementalGenerator {
+public:
+    GenerateResult update(std::string_view grammar_text, const GenerateOptions& options = GenerateOptions());
+
+private:
+    std::shared_ptr<const Grammar> grammar;
+    std::unique_ptr<LRGenerator> generator;
+};
+
+} // namespace seuyacc
+
+#endif // SEUYACC_SEUYACC_H
@@ -0,0 +1,18 @@
+#ifndef SEUYACC_SHIFT_REDUCE_H
+#define SEUYACC_SHIFT_REDUCE_H
+
+#include "parse_tables.h"
+
+namespace seuyacc {
+
+// 合并移入与紧随其后的规约
+//
+// 只有默认规约且右部非空的状态（LR(0) 规约状态）进入后必然立即规约并弹出自身，因此转到这类状态的移入与GOTO
+// 改写为 state_count + 规则号：压入语义值后直接按该规则规约，不再进入该状态。
+// 不再可达的规约状态被删除，state_count 为删除后的状态数；fused_states 非空时返回删除的状态数。
+// 生成的 C 解析器使用该编码，二进制表与 C++ 表的驱动不支持。
+ParseTables fuseShiftReduce(const ParseTables& tables, int* fused_states = nullptr);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_SHIFT_REDUCE_H
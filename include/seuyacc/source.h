@@ -0,0 +1,48 @@
+#ifndef SEUYACC_SOURCE_H
+#define SEUYACC_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace seuyacc {
+
+// 源文件中的位置（行号和列号均从1开始，列号按字节计）
+struct SourceLocation {
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+
+    bool valid() const { return line != 0; }
+};
+
+// 只读内存映射的输入文件
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 打开并映射文件，失败时返回false并在error中给出原因
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    std::string_view view() const { return { data, size }; }
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;
+};
+
+// 用 read() 把整个文件读入 text，失败时返回false并在error中给出原因。
+// 常驻进程读取可能被编辑器原地截断的文件时使用：映射的文件被截断后访问会触发 SIGBUS
+bool readFile(const std::string& path, std::string& text, std::string& error);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_SOURCE_H
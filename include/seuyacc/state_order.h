@@ -0,0 +1,47 @@
+#ifndef SEUYACC_STATE_ORDER_H
+#define SEUYACC_STATE_ORDER_H
+
+#include "parse_tables.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace seuyacc {
+
+// 输出分析表前状态的编号顺序
+enum class StateOrder {
+    CANONICAL, // 构建项集规范族时的编号
+    BFS, // 从初始状态按转移广度优先
+    DFS, // 从初始状态按转移深度优先（先序）
+    PROFILE // 按剖析文件中的访问次数从高到低，热点状态的表项相邻
+};
+
+// 解析 --state-order 选项的取值，无法识别时返回false
+bool parseStateOrder(const std::string& name, StateOrder& order);
+const char* stateOrderName(StateOrder order);
+
+// 计算新的状态顺序：order[新编号] = 原编号，初始状态始终为0
+// profile 为各状态（按原编号）的访问次数，只在 PROFILE 时使用
+std::vector<int> computeStateOrder(const ParseTables& tables, StateOrder order,
+    const std::vector<std::uint64_t>& profile = {});
+
+// 按 order 重新编号状态，同时改写移入与GOTO的目标并记录 state_origin
+ParseTables renumberStates(const ParseTables& tables, const std::vector<int>& order);
+
+// 剖析文件中的一行: 状态在自动机中的原编号与访问次数
+struct StateVisit {
+    std::uint64_t state;
+    std::uint64_t count;
+};
+
+// 解析插桩解析器写出的剖析文件：每行 "状态 次数"，# 开头的行为注释
+// 状态号来自文件，此时还不知道自动机的大小，因此按行原样保存；失败时返回false并设置error
+bool parseStateProfile(std::string_view text, std::vector<StateVisit>& visits, std::string& error);
+
+// 按自动机的 state_count 个状态累加访问次数，状态号超出范围的行计入 ignored
+std::vector<std::uint64_t> stateVisitCounts(const std::vector<StateVisit>& visits, int state_count, std::size_t& ignored);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_STATE_ORDER_H
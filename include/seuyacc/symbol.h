@@ -1,6 +1,7 @@
 #ifndef SEUYACC_SYMBOL_H
 #define SEUYACC_SYMBOL_H
 
+#include "source.h"
 #include <functional>
 #include <stdexcept>
 #include <string>
@@ -30,6 +31,7 @@ struct Symbol {
     std::string value_type; // 符号值的类型（来自%type或%token<type>）
     int precedence; // 优先级，数字越大优先级越高
     Associativity assoc; // 结合性
+    SourceLocation location; // 首次声明或使用的位置
 
     // 构造函数，设置默认值
     Symbol()
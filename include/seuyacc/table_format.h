@@ -0,0 +1,59 @@
+#ifndef SEUYACC_TABLE_FORMAT_H
+#define SEUYACC_TABLE_FORMAT_H
+
+/*
+ * 二进制分析表文件的格式（C 与 C++ 共用）
+ *
+ * 文件由固定大小的文件头和若干段组成，每段都从8字节对齐的偏移开始，
+ * 除 NAMES 段为字节串外，其余段都是本机字节序的 int32_t 数组。
+ * 分析表采用行位移压缩 (comb) 的编码，映射到内存后可以直接查表，无需反序列化。
+ */
+
+#include <stdint.h>
+
+#define SEUYACC_TABLE_MAGIC "SEUYTBL"
+#define SEUYACC_TABLE_VERSION 1
+#define SEUYACC_TABLE_BYTE_ORDER 0x01020304u
+#define SEUYACC_TABLE_ALIGN 8
+
+/* 各段在文件头 sections 中的下标 */
+enum seuyacc_table_section {
+    SEUYACC_SEC_TRANSLATE, /* translate_mod 为0时为直接翻译数组，否则为完美哈希的键 */
+    SEUYACC_SEC_TRANSLATE_VALUES, /* 完美哈希的值，直接数组时为空 */
+    SEUYACC_SEC_DEFACT, /* 每个状态的默认规约：规则号+1，0 表示没有 */
+    SEUYACC_SEC_PACT, /* 每个状态ACTION行的基址 */
+    SEUYACC_SEC_PGOTO, /* 每个非终结符GOTO列的基址 */
+    SEUYACC_SEC_TABLE, /* 压缩后的表项 */
+    SEUYACC_SEC_CHECK, /* 表项所属的终结符或状态 */
+    SEUYACC_SEC_R1, /* 每条规则左部的符号编号 */
+    SEUYACC_SEC_R2, /* 每条规则右部的长度 */
+    SEUYACC_SEC_NAME_OFFSETS, /* 每个符号名在 NAMES 中的偏移，共 token_count + nonterminal_count 项 */
+    SEUYACC_SEC_NAMES, /* 以 '\0' 结尾的符号名 */
+    SEUYACC_SECTION_COUNT
+};
+
+typedef struct seuyacc_table_span {
+    uint32_t offset; /* 相对文件开头的字节偏移 */
+    uint32_t count; /* 元素个数（NAMES 段为字节数） */
+} seuyacc_table_span;
+
+typedef struct seuyacc_table_header {
+    char magic[8]; /* SEUYACC_TABLE_MAGIC */
+    uint32_t version; /* SEUYACC_TABLE_VERSION */
+    uint32_t byte_order; /* 按本机字节序写入的 SEUYACC_TABLE_BYTE_ORDER */
+    uint32_t file_size;
+    uint32_t header_size; /* sizeof(seuyacc_table_header) */
+
+    int32_t state_count;
+    int32_t token_count;
+    int32_t nonterminal_count;
+    int32_t rule_count;
+    int32_t max_user_token;
+    int32_t pact_ninf; /* 没有表项的行/列的基址 (YYPACT_NINF) */
+    int32_t translate_mod; /* 0 表示直接翻译数组 */
+    int32_t reserved;
+
+    seuyacc_table_span sections[SEUYACC_SECTION_COUNT];
+} seuyacc_table_header;
+
+#endif /* SEUYACC_TABLE_FORMAT_H */
@@ -0,0 +1,27 @@
+#ifndef SEUYACC_UNIT_RULES_H
+#define SEUYACC_UNIT_RULES_H
+
+#include "parse_tables.h"
+#include <vector>
+
+namespace seuyacc {
+
+// 单元规约消除的统计
+struct UnitRuleStats {
+    int redirected = 0; // 改向合并状态的转移数
+    int merged_states = 0; // 新增的合并状态数
+    int removed_states = 0; // 不再可达而删除的状态数
+};
+
+// 消除没有语义动作的单元规约 A -> X（Pager 的方法）
+//
+// 状态 p 经符号 X 转到 q，q 在向前看符号 a 上按 A -> X 规约后会转到 goto(p, A)，
+// 于是把 p 经 X 的转移改到合并状态 q'：q' 在这些向前看符号上直接采用 goto(p, A) 的动作（沿单元规约链传递），
+// 其余向前看符号保持 q 的动作，GOTO 行取链上各状态的并集。栈上 X 的语义值原样充当 A 的值，即 $$ = $1。
+// 链上各状态的GOTO有冲突时保留原来的转移。eliminable[规则号] 为 true 的规则才会被消除（右部长度必须为1）。
+ParseTables eliminateUnitRules(const ParseTables& tables, const std::vector<bool>& eliminable,
+    UnitRuleStats* stats = nullptr);
+
+} // namespace seuyacc
+
+#endif // SEUYACC_UNIT_RULES_H
@@ -0,0 +1,187 @@
+#ifndef SEUYACC_PARSER_HPP
+#define SEUYACC_PARSER_HPP
+
+/*
+ * 编译期特化的 LR 解析器 (C++17)
+ *
+ * 分析表来自 seuyacc --cpp 生成的 <文法名>.tab.hpp，以 constexpr 数组的形式作为模板参数传入。
+ * 状态数、终结符数与各表的取值范围都是编译期常量，编译器据此选用最窄的元素类型并折叠越界检查；
+ * 表的编码与二进制分析表相同（行位移压缩），语义动作通过回调按规则号分派。
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace seuyacc {
+
+// 能表示 [Low, High] 的最窄整数类型
+template <long long Low, long long High>
+using int_for = std::conditional_t<(Low >= INT8_MIN && High <= INT8_MAX), std::int8_t,
+    std::conditional_t<(Low >= 0 && High <= UINT8_MAX), std::uint8_t,
+        std::conditional_t<(Low >= INT16_MIN && High <= INT16_MAX), std::int16_t,
+            std::conditional_t<(Low >= 0 && High <= UINT16_MAX), std::uint16_t, std::int32_t>>>>;
+
+// parse 的返回值（语义动作中止时返回动作的返回值）
+enum parse_status {
+    parse_accept = 0,
+    parse_syntax_error = 1
+};
+
+// Tables 为生成的分析表，Value 为语义值类型
+template <class Tables, class Value>
+class basic_parser {
+public:
+    static constexpr int state_count = Tables::state_count;
+    static constexpr int token_count = Tables::token_count;
+    static constexpr int nonterminal_count = Tables::nonterminal_count;
+    static constexpr int rule_count = Tables::rule_count;
+
+    // 比所有动作编码都小，表示 ACTION 表中没有表项
+    static constexpr int no_action = -rule_count - 1;
+
+    // 状态栈的元素类型由状态数决定
+    using state_type = int_for<0, state_count - 1>;
+
+    static_assert(sizeof(Tables::pact) / sizeof(Tables::pact[0]) == state_count, "yypact 的长度应为状态数");
+    static_assert(sizeof(Tables::defact) / sizeof(Tables::defact[0]) == state_count, "yydefact 的长度应为状态数");
+    static_assert(sizeof(Tables::pgoto) / sizeof(Tables::pgoto[0]) == nonterminal_count, "yypgoto 的长度应为非终结符数");
+    static_assert(sizeof(Tables::table) == sizeof(Tables::check) / sizeof(Tables::check[0]) * sizeof(Tables::table[0]),
+        "yytable 与 yycheck 的长度应相同");
+
+    // 词法值对应的终结符编号，未定义时返回 -1
+    static constexpr int translate(int raw)
+    {
+        if (raw < 0 || raw > Tables::max_user_token) {
+            return -1;
+        }
+        if constexpr (Tables::translate_mod == 0) {
+            return Tables::translate[raw];
+        } else {
+            const int slot = raw % Tables::translate_mod;
+            return Tables::translate[slot] == raw ? Tables::translate_values[slot] : -1;
+        }
+    }
+
+    // 查 ACTION 表，没有表项（默认规约或错误）时返回 no_action
+    static constexpr int action(int state, int token)
+    {
+        int n = Tables::pact[state];
+        if (n == Tables::pact_ninf) {
+            return no_action;
+        }
+        n += token;
+        if (n < 0 || n >= table_size || Tables::check[n] != token) {
+            return no_action;
+        }
+        return Tables::table[n];
+    }
+
+    // 查 GOTO 表，没有转移时返回 -1
+    static constexpr int go(int state, int nonterminal)
+    {
+        int n = Tables::pgoto[nonterminal];
+        if (n == Tables::pact_ninf) {
+            return -1;
+        }
+        n += state;
+        if (n < 0 || n >= table_size || Tables::check[n] != state) {
+            return -1;
+        }
+        return Tables::table[n];
+    }
+
+    // 只有默认规约的状态不读入向前看符号
+    static constexpr bool default_only(int state) { return Tables::pact[state] == Tables::pact_ninf; }
+
+    // [0, token_count) 为终结符，其后为非终结符
+    static constexpr const char* symbol_name(int symbol) { return Tables::symbol_names[symbol]; }
+
+    /*
+     * lex:    int(Value& value)，返回下一个词法值（0 表示输入结束）并写入语义值
+     * action: int(int rule, Value& result, Value* values, int length)，values 指向 $1..$n，
+     *         result 为 $$（调用前已按 $$ = $1 初始化）；返回非0时中止解析并作为 parse 的返回值
+     * 栈在多次解析之间复用，同一个解析器对象不能被多个线程同时使用
+     */
+    template <class Lexer, class Action>
+    int parse(Lexer&& lex, Action&& act)
+    {
+        states.clear();
+        values.clear();
+        states.push_back(0);
+        values.emplace_back();
+
+        int state = 0;
+        int token = empty;
+        Value lookahead {};
+        for (;;) {
+            int code;
+            if (default_only(state)) {
+                code = -Tables::defact[state];
+            } else {
+                if (token == empty) {
+                    token = translate(lex(lookahead));
+                }
+                code = token < 0 ? no_action : action(state, token);
+                if (code == no_action && Tables::defact[state] != 0) {
+                    code = -Tables::defact[state];
+                }
+            }
+
+            if (code == no_action) {
+                error_state_ = state;
+                error_token_ = token;
+                return parse_syntax_error;
+            }
+
+            if (code > 0) {
+                // 移入
+                states.push_back(static_cast<state_type>(code));
+                values.push_back(std::move(lookahead));
+                state = code;
+                token = empty;
+            } else if (code < 0) {
+                // 规约: $1..$n 就是值栈顶部连续的 n 项
+                const int rule = -code - 1;
+                const int length = Tables::r2[rule];
+                const std::size_t base = values.size() - length;
+                Value result = length > 0 ? values[base] : Value {};
+                if (const int aborted = act(rule, result, values.data() + base, length)) {
+                    return aborted;
+                }
+
+                states.resize(states.size() - length);
+                values.resize(base);
+                state = go(states.back(), Tables::r1[rule] - token_count);
+                if (state < 0) {
+                    error_state_ = states.back();
+                    error_token_ = token;
+                    return parse_syntax_error;
+                }
+                states.push_back(static_cast<state_type>(state));
+                values.push_back(std::move(result));
+            } else {
+                return parse_accept;
+            }
+        }
+    }
+
+    // 最近一次语法错误所在的状态与向前看终结符
+    int error_state() const { return error_state_; }
+    int error_token() const { return error_token_; }
+
+private:
+    static constexpr int empty = -2; // 尚未读入向前看符号
+    static constexpr int table_size = static_cast<int>(sizeof(Tables::table) / sizeof(Tables::table[0]));
+
+    std::vector<state_type> states;
+    std::vector<Value> values;
+    int error_state_ = -1;
+    int error_token_ = -1;
+};
+
+} // namespace seuyacc
+
+#endif // SEUYACC_PARSER_HPP
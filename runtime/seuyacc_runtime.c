@@ -0,0 +1,366 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "seuyacc_runtime.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SEUYACC_EMPTY -2 /* 尚未读入向前看符号 */
+#define SEUYACC_INITIAL_DEPTH 200
+
+struct seuyacc_tables {
+    const unsigned char* data;
+    size_t size;
+    int mapped;
+
+    const seuyacc_table_header* header;
+    const int32_t* translate;
+    const int32_t* translate_values;
+    const int32_t* defact;
+    const int32_t* pact;
+    const int32_t* pgoto;
+    const int32_t* table;
+    const int32_t* check;
+    const int32_t* r1;
+    const int32_t* r2;
+    const int32_t* name_offsets;
+    const char* names;
+};
+
+/* 段的起点与长度都必须落在文件内，返回段的首地址 */
+static const void* section_at(const seuyacc_tables* t, int section, size_t element_size, uint32_t min_count)
+{
+    const seuyacc_table_span* span = &t->header->sections[section];
+    if (span->offset % SEUYACC_TABLE_ALIGN != 0 || span->offset > t->size || span->count < min_count
+        || (t->size - span->offset) / element_size < span->count) {
+        return NULL;
+    }
+    return t->data + span->offset;
+}
+
+/* 检查表中的取值，解析时据此直接下标访问而不再逐项检查：
+   状态号落在 [0, state_count)，规约编码对应规则 1..rule_count-1（规则 0 是增广产生式，只会被接受），
+   规则左部是非终结符，右部长度非负 */
+static int validate_contents(const seuyacc_tables* t)
+{
+    const seuyacc_table_header* h = t->header;
+    const uint32_t table_count = h->sections[SEUYACC_SEC_TABLE].count;
+    uint32_t i;
+    for (i = 0; i < (uint32_t)h->state_count; i++) {
+        if (t->defact[i] < 0 || t->defact[i] == 1 || t->defact[i] > h->rule_count) {
+            return SEUYACC_TABLES_BAD_FORMAT;
+        }
+    }
+    /* check 非负的槽可能被查到：ACTION 表项为移入状态、规约编码或接受，GOTO 表项为状态 */
+    for (i = 0; i < table_count; i++) {
+        if (t->check[i] >= 0 && (t->table[i] < -h->rule_count || t->table[i] == -1 || t->table[i] >= h->state_count)) {
+            return SEUYACC_TABLES_BAD_FORMAT;
+        }
+    }
+    for (i = 1; i < (uint32_t)h->rule_count; i++) {
+        if (t->r1[i] < h->token_count || t->r1[i] - h->token_count >= h->nonterminal_count || t->r2[i] < 0) {
+            return SEUYACC_TABLES_BAD_FORMAT;
+        }
+    }
+    return SEUYACC_TABLES_OK;
+}
+
+static int bind_sections(seuyacc_tables* t)
+{
+    const seuyacc_table_header* h;
+    if (t->size < sizeof(seuyacc_table_header)) {
+        return SEUYACC_TABLES_BAD_FORMAT;
+    }
+    h = (const seuyacc_table_header*)t->data;
+    t->header = h;
+    if (memcmp(h->magic, SEUYACC_TABLE_MAGIC, sizeof(SEUYACC_TABLE_MAGIC)) != 0
+        || h->byte_order != SEUYACC_TABLE_BYTE_ORDER) {
+        return SEUYACC_TABLES_BAD_FORMAT;
+    }
+    if (h->version != SEUYACC_TABLE_VERSION) {
+        return SEUYACC_TABLES_BAD_VERSION;
+    }
+    if (h->header_size != sizeof(seuyacc_table_header) || h->file_size != t->size || h->state_count <= 0
+        || h->token_count <= 0 || h->nonterminal_count <= 0 || h->rule_count <= 0 || h->translate_mod < 0) {
+        return SEUYACC_TABLES_BAD_FORMAT;
+    }
+
+    t->translate = section_at(t, SEUYACC_SEC_TRANSLATE, 4, h->translate_mod != 0 ? (uint32_t)h->translate_mod : 1);
+    t->translate_values = section_at(t, SEUYACC_SEC_TRANSLATE_VALUES, 4, (uint32_t)h->translate_mod);
+    t->defact = section_at(t, SEUYACC_SEC_DEFACT, 4, (uint32_t)h->state_count);
+    t->pact = section_at(t, SEUYACC_SEC_PACT, 4, (uint32_t)h->state_count);
+    t->pgoto = section_at(t, SEUYACC_SEC_PGOTO, 4, (uint32_t)h->nonterminal_count);
+    t->table = section_at(t, SEUYACC_SEC_TABLE, 4, 0);
+    t->check = section_at(t, SEUYACC_SEC_CHECK, 4, h->sections[SEUYACC_SEC_TABLE].count);
+    t->r1 = section_at(t, SEUYACC_SEC_R1, 4, (uint32_t)h->rule_count);
+    t->r2 = section_at(t, SEUYACC_SEC_R2, 4, (uint32_t)h->rule_count);
+    t->name_offsets = section_at(t, SEUYACC_SEC_NAME_OFFSETS, 4, (uint32_t)(h->token_count + h->nonterminal_count));
+    t->names = section_at(t, SEUYACC_SEC_NAMES, 1, 1);
+    if (!t->translate || !t->translate_values || !t->defact || !t->pact || !t->pgoto || !t->table || !t->check
+        || !t->r1 || !t->r2 || !t->name_offsets || !t->names) {
+        return SEUYACC_TABLES_BAD_FORMAT;
+    }
+    if (h->sections[SEUYACC_SEC_NAMES].count == 0 || t->names[h->sections[SEUYACC_SEC_NAMES].count - 1] != '\0') {
+        return SEUYACC_TABLES_BAD_FORMAT;
+    }
+    return validate_contents(t);
+}
+
+int seuyacc_tables_from_memory(const void* data, size_t size, seuyacc_tables** out)
+{
+    int status;
+    seuyacc_tables* t = calloc(1, sizeof(seuyacc_tables));
+    if (!t) {
+        return SEUYACC_TABLES_NO_MEMORY;
+    }
+    t->data = data;
+    t->size = size;
+
+    status = bind_sections(t);
+    if (status != SEUYACC_TABLES_OK) {
+        free(t);
+        return status;
+    }
+    *out = t;
+    return SEUYACC_TABLES_OK;
+}
+
+int seuyacc_tables_open(const char* path, seuyacc_tables** out)
+{
+    struct stat st;
+    void* addr;
+    int status;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return SEUYACC_TABLES_IO_ERROR;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return SEUYACC_TABLES_IO_ERROR;
+    }
+
+    /* 只读共享映射：多个进程共用页缓存中的同一份表 */
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return SEUYACC_TABLES_IO_ERROR;
+    }
+
+    status = seuyacc_tables_from_memory(addr, (size_t)st.st_size, out);
+    if (status != SEUYACC_TABLES_OK) {
+        munmap(addr, (size_t)st.st_size);
+        return status;
+    }
+    (*out)->mapped = 1;
+    return SEUYACC_TABLES_OK;
+}
+
+void seuyacc_tables_close(seuyacc_tables* tables)
+{
+    if (!tables) {
+        return;
+    }
+    if (tables->mapped) {
+        munmap((void*)tables->data, tables->size);
+    }
+    free(tables);
+}
+
+const seuyacc_table_header* seuyacc_tables_header(const seuyacc_tables* tables)
+{
+    return tables->header;
+}
+
+const char* seuyacc_symbol_name(const seuyacc_tables* tables, int symbol)
+{
+    const seuyacc_table_header* h = tables->header;
+    int32_t offset;
+    if (symbol < 0 || symbol >= h->token_count + h->nonterminal_count) {
+        return NULL;
+    }
+    offset = tables->name_offsets[symbol];
+    if (offset < 0 || (uint32_t)offset >= h->sections[SEUYACC_SEC_NAMES].count) {
+        return NULL;
+    }
+    return tables->names + offset;
+}
+
+int seuyacc_translate(const seuyacc_tables* tables, int raw_token)
+{
+    const seuyacc_table_header* h = tables->header;
+    int slot;
+    if (raw_token < 0 || raw_token > h->max_user_token) {
+        return -1;
+    }
+    if (h->translate_mod == 0) {
+        return (uint32_t)raw_token < h->sections[SEUYACC_SEC_TRANSLATE].count ? tables->translate[raw_token] : -1;
+    }
+    slot = raw_token % h->translate_mod;
+    return tables->translate[slot] == raw_token ? tables->translate_values[slot] : -1;
+}
+
+/* 查ACTION表，不在表中时返回 error_code（由调用者按默认规约或错误处理） */
+static int table_action(const seuyacc_tables* t, int state, int token, int error_code)
+{
+    int n = t->pact[state];
+    if (n == t->header->pact_ninf) {
+        return error_code;
+    }
+    n += token;
+    if (n < 0 || (uint32_t)n >= t->header->sections[SEUYACC_SEC_TABLE].count || t->check[n] != token) {
+        return error_code;
+    }
+    return t->table[n];
+}
+
+static int table_goto(const seuyacc_tables* t, int state, int nonterminal)
+{
+    int n = t->pgoto[nonterminal];
+    if (n == t->header->pact_ninf) {
+        return -1;
+    }
+    n += state;
+    if (n < 0 || (uint32_t)n >= t->header->sections[SEUYACC_SEC_TABLE].count || t->check[n] != state) {
+        return -1;
+    }
+    return t->table[n];
+}
+
+/* 状态栈与语义值栈，按需加倍 */
+typedef struct parse_stack {
+    int* states;
+    unsigned char* values;
+    size_t capacity;
+    size_t value_size;
+} parse_stack;
+
+static int stack_reserve(parse_stack* s, size_t depth)
+{
+    size_t capacity;
+    int* states;
+    unsigned char* values;
+    if (depth < s->capacity) {
+        return 1;
+    }
+    capacity = s->capacity ? s->capacity * 2 : SEUYACC_INITIAL_DEPTH;
+    while (capacity <= depth) {
+        capacity *= 2;
+    }
+    states = realloc(s->states, capacity * sizeof(int));
+    if (!states) {
+        return 0;
+    }
+    s->states = states;
+    values = realloc(s->values, capacity * s->value_size);
+    if (!values) {
+        return 0;
+    }
+    s->values = values;
+    s->capacity = capacity;
+    return 1;
+}
+
+int seuyacc_parse(const seuyacc_tables* tables, const seuyacc_callbacks* callbacks)
+{
+    const seuyacc_table_header* h = tables->header;
+    /* 比所有动作编码都小，表示 ACTION 表中没有表项 */
+    const int no_action = -h->rule_count - 1;
+    const size_t value_size = callbacks->value_size ? callbacks->value_size : 1;
+    parse_stack stack = { NULL, NULL, 0, value_size };
+    unsigned char* lookahead_value = calloc(1, value_size);
+    unsigned char* result = calloc(1, value_size);
+    size_t top = 0;
+    int state = 0;
+    int token = SEUYACC_EMPTY;
+    int status = SEUYACC_PARSE_NO_MEMORY;
+
+    if (!lookahead_value || !result || !stack_reserve(&stack, 0)) {
+        goto done;
+    }
+    stack.states[0] = 0;
+
+    for (;;) {
+        int action;
+        if (tables->pact[state] == h->pact_ninf) {
+            /* 只有默认规约的状态不读入向前看符号 */
+            action = -tables->defact[state];
+        } else {
+            if (token == SEUYACC_EMPTY) {
+                token = seuyacc_translate(tables, callbacks->lex(callbacks->user, lookahead_value));
+            }
+            action = token < 0 ? no_action : table_action(tables, state, token, no_action);
+            if (action == no_action && tables->defact[state] != 0) {
+                action = -tables->defact[state];
+            }
+        }
+
+        if (action == no_action) {
+            if (callbacks->error) {
+                callbacks->error(callbacks->user, state, token);
+            }
+            status = SEUYACC_PARSE_SYNTAX_ERROR;
+            goto done;
+        }
+
+        if (action > 0) {
+            /* 移入 */
+            if (!stack_reserve(&stack, top + 1)) {
+                goto done;
+            }
+            top++;
+            stack.states[top] = action;
+            memcpy(stack.values + top * value_size, lookahead_value, value_size);
+            state = action;
+            token = SEUYACC_EMPTY;
+        } else if (action < 0) {
+            /* 规约: $1..$n 就是值栈中连续的 n 项 */
+            const int rule = -action - 1;
+            const int length = tables->r2[rule];
+            unsigned char* first;
+            int nonterminal;
+            if ((size_t)length > top) {
+                /* 表中的规则长度与栈中的符号数不符 */
+                status = SEUYACC_PARSE_SYNTAX_ERROR;
+                goto done;
+            }
+            first = stack.values + (top - length + 1) * value_size;
+            if (length > 0) {
+                memcpy(result, first, value_size);
+            } else {
+                memset(result, 0, value_size);
+            }
+            if (callbacks->action) {
+                int aborted = callbacks->action(callbacks->user, rule, result, first, length);
+                if (aborted != 0) {
+                    status = aborted;
+                    goto done;
+                }
+            }
+
+            top -= length;
+            nonterminal = tables->r1[rule] - h->token_count;
+            state = table_goto(tables, stack.states[top], nonterminal);
+            if (state < 0 || !stack_reserve(&stack, top + 1)) {
+                status = state < 0 ? SEUYACC_PARSE_SYNTAX_ERROR : SEUYACC_PARSE_NO_MEMORY;
+                goto done;
+            }
+            top++;
+            stack.states[top] = state;
+            memcpy(stack.values + top * value_size, result, value_size);
+        } else {
+            /* 接受 */
+            status = SEUYACC_PARSE_ACCEPT;
+            goto done;
+        }
+    }
+
+done:
+    free(stack.states);
+    free(stack.values);
+    free(lookahead_value);
+    free(result);
+    return status;
+}
@@ -0,0 +1,74 @@
+#ifndef SEUYACC_RUNTIME_H
+#define SEUYACC_RUNTIME_H
+
+/*
+ * 通用的表驱动 LR 解析器
+ *
+ * 分析表来自 seuyacc --binary-tables 生成的 .tables 文件，以只读方式映射到内存后直接查表，
+ * 多个进程映射同一个文件时共用页缓存中的同一份数据。更新文法只需替换表文件，宿主程序无需重新编译。
+ * 语义值是长度为 value_size 字节的不透明数据，语义动作通过回调按规则号分派。
+ */
+
+#include "seuyacc/table_format.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct seuyacc_tables seuyacc_tables;
+
+/* seuyacc_tables_open 的返回值 */
+enum seuyacc_tables_status {
+    SEUYACC_TABLES_OK = 0,
+    SEUYACC_TABLES_IO_ERROR, /* 无法打开或映射文件 */
+    SEUYACC_TABLES_BAD_FORMAT, /* 文件头、字节序、段的范围或表中的取值不合法 */
+    SEUYACC_TABLES_BAD_VERSION, /* 格式版本不受支持 */
+    SEUYACC_TABLES_NO_MEMORY
+};
+
+/* 映射表文件并校验文件头与各段的范围，成功时 *out 为打开的分析表 */
+int seuyacc_tables_open(const char* path, seuyacc_tables** out);
+
+/* 使用调用者提供的内存（需8字节对齐，且在分析表关闭前保持有效） */
+int seuyacc_tables_from_memory(const void* data, size_t size, seuyacc_tables** out);
+
+void seuyacc_tables_close(seuyacc_tables* tables);
+
+const seuyacc_table_header* seuyacc_tables_header(const seuyacc_tables* tables);
+
+/* 符号名：[0, token_count) 为终结符，其后为非终结符；越界时返回 NULL */
+const char* seuyacc_symbol_name(const seuyacc_tables* tables, int symbol);
+
+/* 词法值对应的终结符编号，未定义时返回 -1 */
+int seuyacc_translate(const seuyacc_tables* tables, int raw_token);
+
+/*
+ * 解析回调
+ *   lex:    返回下一个词法值（0 表示输入结束），并把语义值写入 value
+ *   action: 规约规则 rule 时调用，values 指向 $1..$n 共 length 个连续的语义值，
+ *           result 为 $$（调用前已按 $$ = $1 初始化）；返回非0时中止解析并作为 seuyacc_parse 的返回值
+ *   error:  语法错误时调用（可为 NULL），state 为出错的状态，token 为终结符编号
+ */
+typedef struct seuyacc_callbacks {
+    size_t value_size;
+    void* user;
+    int (*lex)(void* user, void* value);
+    int (*action)(void* user, int rule, void* result, void* values, int length);
+    void (*error)(void* user, int state, int token);
+} seuyacc_callbacks;
+
+/* seuyacc_parse 的返回值（语义动作中止时返回动作的返回值） */
+enum seuyacc_parse_status {
+    SEUYACC_PARSE_ACCEPT = 0,
+    SEUYACC_PARSE_SYNTAX_ERROR = 1,
+    SEUYACC_PARSE_NO_MEMORY = 2
+};
+
+int seuyacc_parse(const seuyacc_tables* tables, const seuyacc_callbacks* callbacks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEUYACC_RUNTIME_H */
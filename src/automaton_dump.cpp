@@ -0,0 +1,263 @@
+#include "seuyacc/automaton_dump.h"
+#include "seuyacc/output.h"
+#include <cstdint>
+
+namespace seuyacc {
+
+namespace {
+
+    // 每个格式化块包含的状态数
+    constexpr std::size_t kDumpChunk = 256;
+
+    // 依次访问项集的核心项（点号不在最左，或增广产生式），向前看符号不同的同一项合并为一组
+    template <typename Visit>
+    void forEachKernelGroup(const ItemSet& itemSet, Visit visit)
+    {
+        const std::vector<LRItem>& items = itemSet.items;
+        for (std::size_t k = 0; k < items.size();) {
+            std::size_t end = k + 1;
+            while (end < items.size() && items[end].prod == items[k].prod
+                && items[end].dot_position == items[k].dot_position) {
+                ++end;
+            }
+            if (items[k].dot_position > 0 || items[k].prod == 0) {
+                visit(items.data() + k, items.data() + end);
+            }
+            k = end;
+        }
+    }
+
+    const char* actionName(ActionType type)
+    {
+        switch (type) {
+        case ActionType::SHIFT:
+            return "shift";
+        case ActionType::REDUCE:
+            return "reduce";
+        case ActionType::ACCEPT:
+            return "accept";
+        default:
+            return "error";
+        }
+    }
+
+    // 写出 JSON 字符串（含引号）
+    void writeJsonString(std::ostream& out, const std::string& text)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        out << '"';
+        for (char c : text) {
+            const unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (byte < 0x20) {
+                out << "\\u00" << kHex[byte >> 4] << kHex[byte & 15];
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    void writeJsonLines(std::ostream& out, const Grammar& g, const LRGenerator& generator)
+    {
+        const std::vector<ItemSet>& states = generator.states();
+        const std::vector<StateTransition>& transitions = generator.stateTransitions();
+        const std::vector<ConflictRecord>& conflicts = generator.conflictRecords();
+
+        out << "{\"type\":\"automaton\",\"version\":1,\"states\":" << states.size()
+            << ",\"terminals\":" << g.terminalCount() << ",\"nonterminals\":" << g.nonTerminalCount()
+            << ",\"productions\":" << g.productionCount() << "}\n";
+        for (SymbolId sym = 0; sym < g.symbolCount(); ++sym) {
+            out << "{\"type\":\"symbol\",\"id\":" << sym << ",\"name\":";
+            writeJsonString(out, g.name(sym));
+            out << ",\"terminal\":" << (g.isTerminal(sym) ? "true" : "false") << "}\n";
+        }
+        for (ProductionId prod = 0; prod < g.productionCount(); ++prod) {
+            out << "{\"type\":\"production\",\"id\":" << prod << ",\"lhs\":" << g.left(prod) << ",\"rhs\":[";
+            const SymbolSpan rhs = g.right(prod);
+            for (std::uint32_t i = 0; i < rhs.size(); ++i) {
+                out << (i == 0 ? "" : ",") << rhs[i];
+            }
+            out << "]}\n";
+        }
+
+        // 每个状态一行：核心项为 [产生式, 点号, [向前看...]]，动作为 [符号, 类型, 值]
+        writeChunked(out, states.size(), kDumpChunk, [&](std::ostream& ss, std::size_t first, std::size_t last) {
+            for (std::size_t state = first; state < last; ++state) {
+                const ItemSet& itemSet = states[state];
+                ss << "{\"type\":\"state\",\"id\":" << state << ",\"items\":" << itemSet.items.size() << ",\"kernel\":[";
+                const char* separator = "";
+                forEachKernelGroup(itemSet, [&](const LRItem* begin, const LRItem* end) {
+                    ss << separator << '[' << begin->prod << ',' << begin->dot_position << ",[";
+                    for (const LRItem* item = begin; item != end; ++item) {
+                        ss << (item == begin ? "" : ",") << item->lookahead;
+                    }
+                    ss << "]]";
+                    separator = ",";
+                });
+                ss << "],\"actions\":[";
+                separator = "";
+                const std::vector<ActionEntry>& row = generator.actionRow(static_cast<int>(state));
+                for (SymbolId term = 0; term < row.size(); ++term) {
+                    if (row[term].type != ActionType::ERROR || row[term].value == ActionEntry::kNonassoc) {
+                        ss << separator << '[' << term << ",\"" << actionName(row[term].type) << "\"," << row[term].value << ']';
+                        separator = ",";
+                    }
+                }
+                ss << "]}\n";
+            }
+        }, generator.outputThreads());
+
+        writeChunked(out, transitions.size(), kDumpChunk * 4, [&](std::ostream& ss, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const StateTransition& transition = transitions[i];
+                ss << "{\"type\":\"transition\",\"from\":" << transition.from_state << ",\"symbol\":" << transition.symbol
+                   << ",\"to\":" << transition.to_state << "}\n";
+            }
+        }, generator.outputThreads());
+
+        for (const ConflictRecord& conflict : conflicts) {
+            out << "{\"type\":\"conflict\",\"state\":" << conflict.state << ",\"symbol\":" << conflict.lookahead
+                << ",\"kind\":\"" << (conflict.other.type == ActionType::SHIFT ? "shift/reduce" : "reduce/reduce")
+                << "\",\"reduce\":" << conflict.reduce << ",\"other\":[\"" << actionName(conflict.other.type) << "\","
+                << conflict.other.value << "],\"chosen\":[\"" << actionName(conflict.chosen.type) << "\","
+                << conflict.chosen.value << "],\"resolved\":" << (conflict.resolved ? "true" : "false") << "}\n";
+        }
+
+        out << "{\"type\":\"end\",\"states\":" << states.size() << ",\"transitions\":" << transitions.size()
+            << ",\"conflicts\":" << conflicts.size() << "}\n";
+    }
+
+    // LEB128 无符号变长整数
+    void putVarint(std::ostream& out, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.put(static_cast<char>(value));
+    }
+
+    void writeBinary(std::ostream& out, const Grammar& g, const LRGenerator& generator)
+    {
+        const std::vector<ItemSet>& states = generator.states();
+        const std::vector<StateTransition>& transitions = generator.stateTransitions();
+        const std::vector<ConflictRecord>& conflicts = generator.conflictRecords();
+
+        out.write("SEUYAUT1", 8);
+        out.put(static_cast<char>(AUTOMATON_META));
+        putVarint(out, states.size());
+        putVarint(out, g.terminalCount());
+        putVarint(out, g.nonTerminalCount());
+        putVarint(out, g.productionCount());
+        for (SymbolId sym = 0; sym < g.symbolCount(); ++sym) {
+            out.put(static_cast<char>(AUTOMATON_SYMBOL));
+            putVarint(out, g.name(sym).size());
+            out << g.name(sym);
+            putVarint(out, g.isTerminal(sym) ? 1 : 0);
+        }
+        for (ProductionId prod = 0; prod < g.productionCount(); ++prod) {
+            const SymbolSpan rhs = g.right(prod);
+            out.put(static_cast<char>(AUTOMATON_PRODUCTION));
+            putVarint(out, g.left(prod));
+            putVarint(out, rhs.size());
+            for (SymbolId sym : rhs) {
+                putVarint(out, sym);
+            }
+        }
+
+        writeChunked(out, states.size(), kDumpChunk, [&](std::ostream& ss, std::size_t first, std::size_t last) {
+            for (std::size_t state = first; state < last; ++state) {
+                const ItemSet& itemSet = states[state];
+                std::size_t groups = 0;
+                forEachKernelGroup(itemSet, [&groups](const LRItem*, const LRItem*) { ++groups; });
+
+                ss.put(static_cast<char>(AUTOMATON_STATE));
+                putVarint(ss, state);
+                putVarint(ss, itemSet.items.size());
+                putVarint(ss, groups);
+                forEachKernelGroup(itemSet, [&ss](const LRItem* begin, const LRItem* end) {
+                    putVarint(ss, begin->prod);
+                    putVarint(ss, begin->dot_position);
+                    putVarint(ss, static_cast<std::uint64_t>(end - begin));
+                    for (const LRItem* item = begin; item != end; ++item) {
+                        putVarint(ss, item->lookahead);
+                    }
+                });
+
+                const std::vector<ActionEntry>& row = generator.actionRow(static_cast<int>(state));
+                auto present = [&row](SymbolId term) {
+                    return row[term].type != ActionType::ERROR || row[term].value == ActionEntry::kNonassoc;
+                };
+                std::size_t actions = 0;
+                for (SymbolId term = 0; term < row.size(); ++term) {
+                    actions += present(term) ? 1 : 0;
+                }
+                putVarint(ss, actions);
+                for (SymbolId term = 0; term < row.size(); ++term) {
+                    if (present(term)) {
+                        putVarint(ss, term);
+                        putVarint(ss, static_cast<std::uint64_t>(row[term].type));
+                        putVarint(ss, static_cast<std::uint64_t>(row[term].value));
+                    }
+                }
+            }
+        }, generator.outputThreads());
+
+        writeChunked(out, transitions.size(), kDumpChunk * 4, [&](std::ostream& ss, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                ss.put(static_cast<char>(AUTOMATON_TRANSITION));
+                putVarint(ss, static_cast<std::uint64_t>(transitions[i].from_state));
+                putVarint(ss, transitions[i].symbol);
+                putVarint(ss, static_cast<std::uint64_t>(transitions[i].to_state));
+            }
+        }, generator.outputThreads());
+
+        for (const ConflictRecord& conflict : conflicts) {
+            out.put(static_cast<char>(AUTOMATON_CONFLICT));
+            putVarint(out, static_cast<std::uint64_t>(conflict.state));
+            putVarint(out, conflict.lookahead);
+            putVarint(out, static_cast<std::uint64_t>(conflict.reduce));
+            putVarint(out, static_cast<std::uint64_t>(conflict.other.type));
+            putVarint(out, static_cast<std::uint64_t>(conflict.other.value));
+            putVarint(out, static_cast<std::uint64_t>(conflict.chosen.type));
+            putVarint(out, static_cast<std::uint64_t>(conflict.chosen.value));
+            putVarint(out, conflict.resolved ? 1 : 0);
+        }
+
+        out.put(static_cast<char>(AUTOMATON_END));
+        putVarint(out, states.size());
+        putVarint(out, transitions.size());
+        putVarint(out, conflicts.size());
+    }
+
+} // namespace
+
+bool parseAutomatonFormat(const std::string& name, AutomatonFormat& format)
+{
+    if (name == "jsonl") {
+        format = AutomatonFormat::JSON_LINES;
+    } else if (name == "binary") {
+        format = AutomatonFormat::BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* automatonExtension(AutomatonFormat format)
+{
+    return format == AutomatonFormat::BINARY ? ".automaton.bin" : ".automaton.jsonl";
+}
+
+void writeAutomaton(std::ostream& out, const Grammar& grammar, const LRGenerator& generator, AutomatonFormat format)
+{
+    if (format == AutomatonFormat::BINARY) {
+        writeBinary(out, grammar, generator);
+    } else if (format == AutomatonFormat::JSON_LINES) {
+        writeJsonLines(out, grammar, generator);
+    }
+}
+
+} // namespace seuyacc
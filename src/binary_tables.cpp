@@ -0,0 +1,84 @@
+#include "seuyacc/binary_tables.h"
+#include "seuyacc/table_format.h"
+#include <cstring>
+
+namespace seuyacc {
+
+std::string serializeBinaryTables(const ParseTables& tables)
+{
+    const CombTables comb = compressComb(tables);
+
+    seuyacc_table_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SEUYACC_TABLE_MAGIC, sizeof(SEUYACC_TABLE_MAGIC));
+    header.version = SEUYACC_TABLE_VERSION;
+    header.byte_order = SEUYACC_TABLE_BYTE_ORDER;
+    header.header_size = sizeof(seuyacc_table_header);
+    header.state_count = tables.state_count;
+    header.token_count = tables.token_count;
+    header.nonterminal_count = tables.nonterminal_count;
+    header.rule_count = static_cast<std::int32_t>(tables.rule_length.size());
+    header.max_user_token = tables.max_user_token;
+    header.pact_ninf = comb.base_ninf;
+
+    // 文件头之后依次存放各段，每段从8字节对齐的位置开始
+    std::string body;
+    auto align = [&body]() {
+        while ((sizeof(seuyacc_table_header) + body.size()) % SEUYACC_TABLE_ALIGN != 0) {
+            body.push_back('\0');
+        }
+    };
+    auto addInts = [&](int section, const std::vector<int>& values) {
+        align();
+        header.sections[section].offset = static_cast<std::uint32_t>(sizeof(seuyacc_table_header) + body.size());
+        header.sections[section].count = static_cast<std::uint32_t>(values.size());
+        for (int value : values) {
+            const std::int32_t element = value;
+            body.append(reinterpret_cast<const char*>(&element), sizeof(element));
+        }
+    };
+
+    if (tables.sparse_translate.empty()) {
+        addInts(SEUYACC_SEC_TRANSLATE, tables.translate);
+        addInts(SEUYACC_SEC_TRANSLATE_VALUES, {});
+    } else {
+        const TranslateHash hash = buildTranslateHash(tables.sparse_translate);
+        header.translate_mod = hash.modulus;
+        addInts(SEUYACC_SEC_TRANSLATE, hash.keys);
+        addInts(SEUYACC_SEC_TRANSLATE_VALUES, hash.values);
+    }
+    addInts(SEUYACC_SEC_DEFACT, tables.default_reduction);
+    addInts(SEUYACC_SEC_PACT, comb.pact);
+    addInts(SEUYACC_SEC_PGOTO, comb.pgoto);
+    addInts(SEUYACC_SEC_TABLE, comb.table);
+    addInts(SEUYACC_SEC_CHECK, comb.check);
+    addInts(SEUYACC_SEC_R1, tables.rule_lhs);
+    addInts(SEUYACC_SEC_R2, tables.rule_length);
+
+    // 符号名: 终结符在前，非终结符在后
+    std::vector<int> nameOffsets;
+    std::string names;
+    auto addName = [&](const std::string& name) {
+        nameOffsets.push_back(static_cast<int>(names.size()));
+        names += name;
+        names.push_back('\0');
+    };
+    for (const std::string& name : tables.token_names) {
+        addName(name);
+    }
+    for (const std::string& name : tables.nonterminal_names) {
+        addName(name);
+    }
+    addInts(SEUYACC_SEC_NAME_OFFSETS, nameOffsets);
+
+    align();
+    header.sections[SEUYACC_SEC_NAMES].offset = static_cast<std::uint32_t>(sizeof(seuyacc_table_header) + body.size());
+    header.sections[SEUYACC_SEC_NAMES].count = static_cast<std::uint32_t>(names.size());
+    body += names;
+    align();
+
+    header.file_size = static_cast<std::uint32_t>(sizeof(seuyacc_table_header) + body.size());
+    return std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + body;
+}
+
+} // namespace seuyacc
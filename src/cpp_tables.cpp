@@ -0,0 +1,147 @@
+#include "seuyacc/cpp_tables.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace seuyacc {
+
+namespace {
+
+    bool isIdentifier(const std::string& name)
+    {
+        if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+            return false;
+        }
+        return std::all_of(name.begin(), name.end(),
+            [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+    }
+
+    // 文件名去掉目录与 .tab.hpp 后缀，非法字符换成下划线，作为命名空间
+    std::string namespaceName(const std::string& filename)
+    {
+        std::string base = filename.substr(filename.find_last_of("/\\") + 1);
+        base = base.substr(0, base.find('.'));
+        for (char& c : base) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                c = '_';
+            }
+        }
+        if (base.empty() || std::isdigit(static_cast<unsigned char>(base[0]))) {
+            base = "yy_" + base;
+        }
+        return base;
+    }
+
+    // 输出 constexpr 数组，元素类型由 seuyacc::int_for 按取值范围在编译期选定
+    void emitConstexprArray(std::stringstream& ss, const char* name, const std::vector<int>& values)
+    {
+        int low = 0;
+        int high = 0;
+        for (int value : values) {
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        ss << "    static constexpr seuyacc::int_for<" << low << ", " << high << "> " << name << "[] = {\n        ";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            ss << values[i];
+            if (i + 1 != values.size()) {
+                ss << ((i + 1) % 16 == 0 ? ",\n        " : ", ");
+            }
+        }
+        ss << "\n    };\n";
+    }
+
+} // namespace
+
+std::string generateCppTables(const ParseTables& tables, const std::string& filename)
+{
+    const CombTables comb = compressComb(tables);
+    const std::string ns = namespaceName(filename);
+    std::string guard = ns + "_TAB_HPP";
+    std::transform(guard.begin(), guard.end(), guard.begin(),
+        [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+
+    std::stringstream ss;
+    ss << "/* 由 SeuYacc 生成的 C++17 分析表 */\n\n";
+    ss << "#ifndef " << guard << "\n";
+    ss << "#define " << guard << "\n\n";
+    ss << "#include \"seuyacc_parser.hpp\"\n\n";
+    ss << "namespace " << ns << " {\n\n";
+
+    // 具名终结符的词法值，词法分析器返回这些值
+    std::vector<std::pair<int, int>> rawValues = tables.sparse_translate;
+    for (std::size_t raw = 0; raw < tables.translate.size(); ++raw) {
+        if (tables.translate[raw] >= 0) {
+            rawValues.emplace_back(static_cast<int>(raw), tables.translate[raw]);
+        }
+    }
+    std::sort(rawValues.begin(), rawValues.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+    ss << "// 具名终结符的词法值\n";
+    ss << "namespace token {\n";
+    for (const auto& [raw, token] : rawValues) {
+        const std::string& name = tables.token_names[token];
+        if (isIdentifier(name)) {
+            ss << "    inline constexpr int " << name << " = " << raw << ";\n";
+        }
+    }
+    ss << "} // namespace token\n\n";
+
+    ss << "struct tables {\n";
+    ss << "    static constexpr int state_count = " << tables.state_count << ";\n";
+    ss << "    static constexpr int token_count = " << tables.token_count << ";\n";
+    ss << "    static constexpr int nonterminal_count = " << tables.nonterminal_count << ";\n";
+    ss << "    static constexpr int rule_count = " << tables.rule_length.size() << ";\n";
+    ss << "    static constexpr int max_user_token = " << tables.max_user_token << ";\n";
+    ss << "    static constexpr int pact_ninf = " << comb.base_ninf << ";\n\n";
+
+    // 词法值翻译: translate_mod 为0时为直接数组，否则为完美哈希的键与值
+    if (tables.sparse_translate.empty()) {
+        ss << "    static constexpr int translate_mod = 0;\n";
+        emitConstexprArray(ss, "translate", tables.translate);
+    } else {
+        const TranslateHash hash = buildTranslateHash(tables.sparse_translate);
+        ss << "    static constexpr int translate_mod = " << hash.modulus << ";\n";
+        emitConstexprArray(ss, "translate", hash.keys);
+        emitConstexprArray(ss, "translate_values", hash.values);
+    }
+
+    ss << "\n    // 每个状态的默认规约: 规则号+1，0 表示没有默认规约\n";
+    emitConstexprArray(ss, "defact", tables.default_reduction);
+    ss << "    // ACTION 行与 GOTO 列在 table 中的基址，check 记录表项所属的终结符或状态\n";
+    emitConstexprArray(ss, "pact", comb.pact);
+    emitConstexprArray(ss, "pgoto", comb.pgoto);
+    emitConstexprArray(ss, "table", comb.table);
+    emitConstexprArray(ss, "check", comb.check);
+    ss << "    // 每条规则左部的符号编号与右部的长度\n";
+    emitConstexprArray(ss, "r1", tables.rule_lhs);
+    emitConstexprArray(ss, "r2", tables.rule_length);
+
+    ss << "\n    static constexpr const char* symbol_names[] = {\n";
+    auto emitName = [&ss](const std::string& name) {
+        ss << "        \"";
+        for (char c : name) {
+            if (c == '"' || c == '\\') {
+                ss << '\\';
+            }
+            ss << c;
+        }
+        ss << "\",\n";
+    };
+    for (const std::string& name : tables.token_names) {
+        emitName(name);
+    }
+    for (const std::string& name : tables.nonterminal_names) {
+        emitName(name);
+    }
+    ss << "    };\n";
+    ss << "};\n\n";
+
+    ss << "template <class Value>\n";
+    ss << "using parser = seuyacc::basic_parser<tables, Value>;\n\n";
+    ss << "} // namespace " << ns << "\n\n";
+    ss << "#endif // " << guard << "\n";
+    return ss.str();
+}
+
+} // namespace seuyacc
@@ -0,0 +1,47 @@
+#include "seuyacc/export_filter.h"
+#include <charconv>
+
+namespace seuyacc {
+
+bool parseStateRanges(std::string_view text, std::vector<std::pair<int, int>>& ranges, std::string& error)
+{
+    auto parseNumber = [&error](std::string_view field, int& value) {
+        const char* end = field.data() + field.size();
+        auto [ptr, ec] = std::from_chars(field.data(), end, value);
+        if (ec != std::errc() || ptr != end || value < 0) {
+            error = "无效的状态编号: " + std::string(field);
+            return false;
+        }
+        return true;
+    };
+
+    ranges.clear();
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+
+        const std::size_t dash = item.find('-');
+        int first = 0;
+        int last = 0;
+        if (!parseNumber(item.substr(0, dash), first)) {
+            return false;
+        }
+        last = first;
+        if (dash != std::string_view::npos && !parseNumber(item.substr(dash + 1), last)) {
+            return false;
+        }
+        if (last < first) {
+            error = "状态区间的终点小于起点: " + std::string(item);
+            return false;
+        }
+        ranges.emplace_back(first, last);
+    }
+    if (ranges.empty()) {
+        error = "状态列表为空";
+        return false;
+    }
+    return true;
+}
+
+} // namespace seuyacc
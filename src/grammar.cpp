@@ -0,0 +1,155 @@
+#include "seuyacc/grammar.h"
+#include "seuyacc/parser.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace seuyacc {
+
+std::shared_ptr<const Grammar> Grammar::freeze(const YaccParser& parser)
+{
+    std::shared_ptr<Grammar> g(new Grammar());
+
+    // 收集终结符（$ 在最前，其余按解析阶段分配的id排序）与非终结符（按名称排序）
+    std::vector<const Symbol*> terminals;
+    std::vector<const Symbol*> nonTerminals;
+    const Symbol* endSymbol = nullptr;
+
+    for (const auto& [name, symbol] : parser.symbol_table) {
+        if (name == "$") {
+            endSymbol = &symbol;
+            continue;
+        }
+        if (name == "ε" || name == "S'") {
+            continue;
+        }
+        if (symbol.type == ElementType::NON_TERMINAL) {
+            nonTerminals.push_back(&symbol);
+        } else {
+            terminals.push_back(&symbol);
+        }
+    }
+
+    if (endSymbol == nullptr) {
+        throw std::runtime_error("未在符号表中找到符号: $");
+    }
+
+    std::sort(terminals.begin(), terminals.end(), [](const Symbol* a, const Symbol* b) {
+        return a->id < b->id;
+    });
+    std::sort(nonTerminals.begin(), nonTerminals.end(), [](const Symbol* a, const Symbol* b) {
+        return a->name < b->name;
+    });
+
+    auto addSymbol = [&g](const Symbol& sym) {
+        SymbolId id = static_cast<SymbolId>(g->names.size());
+        g->names.push_back(sym.name);
+        g->value_types.push_back(sym.value_type);
+        g->kinds.push_back(sym.type);
+        g->precedences.push_back(sym.precedence);
+        g->assocs.push_back(sym.assoc);
+        g->ids_by_name.emplace(sym.name, id);
+    };
+
+    addSymbol(*endSymbol);
+    for (const Symbol* sym : terminals) {
+        addSymbol(*sym);
+    }
+    g->terminal_count = static_cast<std::uint32_t>(g->names.size());
+
+    for (const Symbol* sym : nonTerminals) {
+        addSymbol(*sym);
+    }
+    addSymbol(Symbol("S'", ElementType::NON_TERMINAL));
+
+    // 起始符号：未指定 %start 时使用第一条规则的左部
+    std::string startName = parser.start_symbol;
+    if (startName.empty() && !parser.productions.empty()) {
+        startName = parser.productions.front().left.name;
+    }
+    g->start_symbol = g->find(startName);
+    if (g->start_symbol == kInvalidSymbol || !g->isNonTerminal(g->start_symbol)) {
+        throw std::runtime_error("起始符号不是非终结符: " + startName);
+    }
+
+    auto resolve = [&g](const Symbol& sym) {
+        SymbolId id = g->find(sym.name);
+        if (id == kInvalidSymbol) {
+            throw std::runtime_error("未在符号表中找到符号: " + sym.name);
+        }
+        return id;
+    };
+
+    // 产生式 0 为增广产生式 S' -> start
+    const std::size_t productionCount = parser.productions.size() + 1;
+    g->lhs.reserve(productionCount);
+    g->rhs_offsets.reserve(productionCount + 1);
+    g->production_precedences.reserve(productionCount);
+    g->semantic_actions.reserve(productionCount);
+
+    g->rhs_offsets.push_back(0);
+    g->lhs.push_back(g->augmentedStart());
+    g->rhs_symbols.push_back(g->start_symbol);
+    g->rhs_offsets.push_back(static_cast<std::uint32_t>(g->rhs_symbols.size()));
+    g->production_precedences.push_back(0);
+    g->semantic_actions.emplace_back();
+
+    for (const Production& prod : parser.productions) {
+        g->lhs.push_back(resolve(prod.left));
+        for (const Symbol& sym : prod.right) {
+            g->rhs_symbols.push_back(resolve(sym));
+        }
+        g->rhs_offsets.push_back(static_cast<std::uint32_t>(g->rhs_symbols.size()));
+        g->production_precedences.push_back(prod.precedence);
+        g->semantic_actions.push_back(prod.semantic_action);
+    }
+
+    // 按左部分组（计数排序，保持组内的产生式顺序）
+    const std::uint32_t groupCount = g->nonTerminalCount() + 1;
+    g->lhs_offsets.assign(groupCount + 1, 0);
+    for (SymbolId left : g->lhs) {
+        g->lhs_offsets[g->nonTerminalIndex(left) + 1]++;
+    }
+    for (std::uint32_t i = 0; i < groupCount; ++i) {
+        g->lhs_offsets[i + 1] += g->lhs_offsets[i];
+    }
+    g->productions_by_lhs.resize(g->lhs.size());
+    std::vector<std::uint32_t> cursor(g->lhs_offsets.begin(), g->lhs_offsets.end() - 1);
+    for (ProductionId p = 0; p < g->lhs.size(); ++p) {
+        g->productions_by_lhs[cursor[g->nonTerminalIndex(g->lhs[p])]++] = p;
+    }
+
+    g->declaration_code = parser.declaration_code;
+    g->union_code = parser.union_code;
+    g->program_code = parser.program_code;
+    g->pure_parser = parser.pure_parser;
+    g->pull_parser = parser.pull_parser;
+    g->push_parser = parser.push_parser;
+
+    return g;
+}
+
+bool Grammar::sameStructure(const Grammar& other) const
+{
+    return terminal_count == other.terminal_count
+        && start_symbol == other.start_symbol
+        && names == other.names
+        && kinds == other.kinds
+        && lhs == other.lhs
+        && rhs_offsets == other.rhs_offsets
+        && rhs_symbols == other.rhs_symbols;
+}
+
+bool Grammar::samePrecedence(const Grammar& other) const
+{
+    return precedences == other.precedences
+        && assocs == other.assocs
+        && production_precedences == other.production_precedences;
+}
+
+SymbolId Grammar::find(const std::string& name) const
+{
+    auto it = ids_by_name.find(name);
+    return it == ids_by_name.end() ? kInvalidSymbol : it->second;
+}
+
+} // namespace seuyacc
@@ -1,26 +1,165 @@
 #include "seuyacc/lr_generator.h"
+#include "seuyacc/output.h"
 #include <algorithm>
 #include <cctype>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace seuyacc {
 
+namespace {
+
+    // 核心项集（已排序）的哈希，用于识别重复状态
+    struct KernelHasher {
+        size_t operator()(const std::vector<LRItem>& kernel) const
+        {
+            size_t h = kernel.size();
+            for (const LRItem& item : kernel) {
+                h ^= item.hash() + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+    };
+
+    bool orInto(std::uint64_t* dst, const std::uint64_t* src, std::size_t words)
+    {
+        bool changed = false;
+        for (std::size_t i = 0; i < words; ++i) {
+            std::uint64_t merged = dst[i] | src[i];
+            if (merged != dst[i]) {
+                dst[i] = merged;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // 写出Markdown表格单元格中的符号名，转义其中的竖线
+    void writeCellName(std::ostream& out, std::string_view name)
+    {
+        for (char c : name) {
+            if (c == '|') {
+                out << '\\';
+            }
+            out << c;
+        }
+    }
+
+    // 按取值范围选用最窄的元素类型 (yytype_int8/uint8/int16/uint16/int32)，bytes 为元素字节数
+    const char* elementType(const std::vector<int>& values, std::size_t& bytes)
+    {
+        int low = 0;
+        int high = 0;
+        for (int value : values) {
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        if (low >= -128 && high <= 127) {
+            bytes = 1;
+            return "yytype_int8";
+        }
+        if (low >= 0 && high <= 255) {
+            bytes = 1;
+            return "yytype_uint8";
+        }
+        if (low >= -32768 && high <= 32767) {
+            bytes = 2;
+            return "yytype_int16";
+        }
+        if (low >= 0 && high <= 65535) {
+            bytes = 2;
+            return "yytype_uint16";
+        }
+        bytes = 4;
+        return "yytype_int32";
+    }
+
+    // 分析表的元素类型，解析器与单独输出的分析表使用相同的定义
+    const char* const kTableTypedefs = "/* 分析表的元素类型，每张表按取值范围选用最窄的类型 */\n"
+                                       "typedef signed char yytype_int8;\n"
+                                       "typedef unsigned char yytype_uint8;\n"
+                                       "typedef short yytype_int16;\n"
+                                       "typedef unsigned short yytype_uint16;\n"
+                                       "typedef int yytype_int32;\n\n";
+
+    // 超过该元素数的数组分块并行格式化
+    constexpr std::size_t kTableChunk = 1 << 16;
+    // Markdown 与 PlantUML 按状态分块并行格式化的块大小
+    constexpr std::size_t kStateChunk = 256;
+
+    // 输出一个常量数组并累计其字节数，分块格式化时使用 threads 中的额外线程；rowLength 大于0时每行前加状态注释。
+    // definitions 非空时数组定义写入单独的分析表翻译单元，ss 中只留 extern 声明
+    void emitTableArray(std::ostream& ss, const char* name, const std::vector<int>& values,
+        std::size_t& totalBytes, ThreadBudget* threads, int rowLength = 0, std::ostream* definitions = nullptr)
+    {
+        std::size_t bytes = 0;
+        const char* type = elementType(values, bytes);
+        totalBytes += values.size() * bytes;
+
+        if (definitions != nullptr) {
+            // 先声明为 extern，按 C++ 编译时 const 数组也具有外部链接
+            ss << "extern const " << type << " " << name << "[" << values.size() << "];\n\n";
+            *definitions << "extern const " << type << " " << name << "[" << values.size() << "];\n";
+            *definitions << "const " << type << " " << name << "[" << values.size() << "] = {\n";
+        } else {
+            ss << "static const " << type << " " << name << "[] = {\n";
+        }
+        std::ostream& target = definitions != nullptr ? *definitions : ss;
+        if (rowLength > 0) {
+            // 按整行分块，每块以状态注释开头
+            const std::size_t rowsPerChunk = std::max<std::size_t>(1, kTableChunk / rowLength);
+            writeChunked(target, values.size() / rowLength, rowsPerChunk,
+                [&values, rowLength](std::ostream& out, std::size_t first, std::size_t last) {
+                    for (std::size_t row = first; row < last; ++row) {
+                        out << "  /* 状态 " << row << " */\n  ";
+                        for (std::size_t i = row * rowLength; i < (row + 1) * rowLength; ++i) {
+                            out << values[i] << ", ";
+                        }
+                        out << "\n";
+                    }
+                }, threads);
+            target << "};\n\n";
+            return;
+        }
+        target << "  ";
+        writeChunked(target, values.size(), kTableChunk, [&values](std::ostream& out, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                out << values[i];
+                if (i + 1 != values.size()) {
+                    out << ((i + 1) % 16 == 0 ? ",\n  " : ", ");
+                }
+            }
+        }, threads);
+        target << "\n};\n\n";
+    }
+
+} // namespace
+
 LRGenerator::LRGenerator(const YaccParser& p)
-    : parser(p)
+    : LRGenerator(p.grammar())
 {
-    // 初始化
+}
+
+LRGenerator::LRGenerator(std::shared_ptr<const Grammar> g)
+    : grammar(std::move(g))
+{
+    if (!grammar) {
+        throw std::runtime_error("文法尚未解析，无法生成分析表");
+    }
 }
 
 void LRGenerator::generateTable()
 {
-    first_cache.clear();
     canonical_collection.clear();
     transitions.clear();
     action_table.clear();
     goto_table.clear();
 
+    // 计算FIRST集
+    computeFirstSets();
+
     // 构建规范项集族
     buildCanonicalCollection();
 
@@ -28,154 +167,118 @@ void LRGenerator::generateTable()
     buildActionGotoTable();
 }
 
-std::unordered_set<Symbol, SymbolHasher> LRGenerator::computeFirst(const Symbol& symbol)
+bool LRGenerator::rebind(std::shared_ptr<const Grammar> next)
 {
-    // 检查缓存
-    if (first_cache.find(symbol) != first_cache.end()) {
-        // 已经计算过，直接返回缓存结果，不输出任何信息
-        return first_cache[symbol];
+    if (!next || canonical_collection.empty() || !grammar->sameStructure(*next)) {
+        return false;
     }
 
-    // 防止左递归导致的栈溢出：先插入空集
-    std::unordered_set<Symbol, SymbolHasher> result;
-    first_cache[symbol] = result;
-
-    const Symbol& epsilon_symbol = parser.getSymbol("ε");
-
-    // 终结符或字面量的FIRST集就是其自身
-    if (symbol.type == ElementType::TOKEN || symbol.type == ElementType::LITERAL) {
-        result.insert(symbol);
-        first_cache[symbol] = result;
-        return result;
+    // FIRST集、项集规范族与转移只依赖文法结构，可以直接复用
+    const bool rebuildTables = !grammar->samePrecedence(*next);
+    grammar = std::move(next);
+    if (rebuildTables) {
+        buildActionGotoTable();
     }
+    return true;
+}
 
-    Symbol::ensureIdAssigned(symbol, "LRGenerator::computeFirst");
+void LRGenerator::computeFirstSets()
+{
+    const Grammar& g = *grammar;
+    const std::uint32_t ntCount = g.nonTerminalCount() + 1; // 包含 S'
 
-    std::vector<const Production*> candidates;
-    candidates.reserve(8);
-    for (const auto& prod : parser.productions) {
-        if (prod.left.id == symbol.id) {
-            candidates.push_back(&prod);
-        }
-    }
+    terminal_words = (g.terminalCount() + 63) / 64;
+    first_sets.assign(static_cast<std::size_t>(ntCount) * terminal_words, 0);
+    nullable.assign(ntCount, false);
 
-    if (candidates.empty()) {
-        std::cout << "  警告: 没有找到非终结符 " << symbol.name << " 的产生式!" << std::endl;
-        first_cache[symbol] = result;
-        return result;
-    }
+    // 不动点迭代：反复扫描所有产生式，直到FIRST集与可空性都不再变化
     bool changed = true;
-
-    // 使用固定点算法：不断扩展结果，直到不再变化
     while (changed) {
         changed = false;
-        for (const auto* prodPtr : candidates) {
-            const Production& prod = *prodPtr;
-
-            // 如果右部为空，添加空符号
-            if (prod.right.empty()) {
-                if (result.insert(epsilon_symbol).second) {
-                    changed = true;
-                }
-                continue;
-            }
-
-            int i = 0;
-            bool allCanDeriveEmpty = true;
-
-            while (i < static_cast<int>(prod.right.size()) && allCanDeriveEmpty) {
-                const Symbol& current = prod.right[i];
-
-                // 如果右部第i个符号就是正在计算的符号，则跳过
-                if (current.name == symbol.name && current.type == symbol.type) {
-                    i++;
-                    continue;
-                }
-
-                auto firstOfRight = computeFirst(current);
-                allCanDeriveEmpty = (firstOfRight.find(epsilon_symbol) != firstOfRight.end());
-
-                for (const auto& s : firstOfRight) {
-                    if (s.name != "ε" && result.insert(s).second) {
+        for (ProductionId p = 0; p < g.productionCount(); ++p) {
+            const std::uint32_t left = g.nonTerminalIndex(g.left(p));
+            const SymbolSpan rhs = g.right(p);
+            std::uint64_t* target = &first_sets[left * terminal_words];
+
+            bool allNullable = true;
+            for (SymbolId sym : rhs) {
+                if (g.isTerminal(sym)) {
+                    std::uint64_t bit = std::uint64_t(1) << (sym % 64);
+                    if (!(target[sym / 64] & bit)) {
+                        target[sym / 64] |= bit;
                         changed = true;
                     }
+                    allNullable = false;
+                    break;
                 }
 
-                i++;
-            }
-
-            if (!allCanDeriveEmpty) {
-                continue;
+                const std::uint32_t index = g.nonTerminalIndex(sym);
+                if (index != left && orInto(target, &first_sets[index * terminal_words], terminal_words)) {
+                    changed = true;
+                }
+                if (!nullable[index]) {
+                    allNullable = false;
+                    break;
+                }
             }
 
-            if (result.insert(epsilon_symbol).second) {
+            if (allNullable && !nullable[left]) {
+                nullable[left] = true;
                 changed = true;
             }
         }
     }
 
-    // 更新缓存
-    first_cache[symbol] = result;
-
-    return result;
+    for (std::uint32_t i = 0; i + 1 < ntCount; ++i) {
+        if (g.productionsOfBegin(g.terminalCount() + i) == g.productionsOfEnd(g.terminalCount() + i)) {
+            *out_stream << "  警告: 没有找到非终结符 " << g.name(g.terminalCount() + i) << " 的产生式!" << std::endl;
+        }
+    }
 }
 
-std::unordered_set<Symbol, SymbolHasher> LRGenerator::computeFirstOfSequence(const std::vector<Symbol>& sequence)
+bool LRGenerator::addFirstOfSequence(const SymbolId* begin, const SymbolId* end, std::uint64_t* out) const
 {
-    std::unordered_set<Symbol, SymbolHasher> result;
-    const Symbol& epsilon_symbol = parser.getSymbol("ε");
-
-    if (sequence.empty()) {
-        // 空序列的FIRST集包含ε
-        result.insert(epsilon_symbol);
-        return result;
-    }
-
-    // 计算序列第一个符号的FIRST集
-    auto firstOfFirst = computeFirst(sequence[0]);
-    result.insert(firstOfFirst.begin(), firstOfFirst.end());
-
-    // 如果序列还有更多符号且当前符号可能推导出空，则继续计算
-    int i = 1;
-    while (i < sequence.size() && firstOfFirst.find(epsilon_symbol) != firstOfFirst.end()) {
-        // 移除epsilon，因为它不会出现在FIRST(αβ)中，除非所有符号都能推导出空
-        result.erase(epsilon_symbol);
-
-        // 计算下一个符号的FIRST集
-        firstOfFirst = computeFirst(sequence[i]);
-        result.insert(firstOfFirst.begin(), firstOfFirst.end());
-        i++;
+    const Grammar& g = *grammar;
+    for (const SymbolId* it = begin; it != end; ++it) {
+        if (g.isTerminal(*it)) {
+            out[*it / 64] |= std::uint64_t(1) << (*it % 64);
+            return false;
+        }
+        const std::uint32_t index = g.nonTerminalIndex(*it);
+        orInto(out, &first_sets[index * terminal_words], terminal_words);
+        if (!nullable[index]) {
+            return false;
+        }
     }
-
-    return result;
+    return true;
 }
 
 void LRGenerator::buildActionGotoTable()
 {
+    const Grammar& g = *grammar;
     int shift_reduce_conflicts = 0;
     int resolved_sr_conflicts = 0;
     int reduce_reduce_conflicts = 0;
     int resolved_rr_conflicts = 0;
 
-    for (const ItemSet& state : canonical_collection) {
-        const int stateId = state.state_id;
+    action_table.assign(canonical_collection.size(), std::vector<ActionEntry>(g.terminalCount(), { ActionType::ERROR, 0 }));
+    goto_table.assign(canonical_collection.size(), std::vector<int>(g.nonTerminalCount(), -1));
+    conflicts.clear();
 
+    // 先填入所有规约动作，再处理移入和GOTO，与逐状态处理的结果相同
+    for (const ItemSet& state : canonical_collection) {
         for (const LRItem& item : state.items) {
             if (isReduceItem(item)) {
-                applyReduceAction(stateId, item, reduce_reduce_conflicts, resolved_rr_conflicts);
+                applyReduceAction(state.state_id, item, reduce_reduce_conflicts, resolved_rr_conflicts);
             }
         }
+    }
 
-        for (const StateTransition& transition : transitions) {
-            if (transition.from_state != stateId) {
-                continue;
-            }
-
-            if (transition.symbol.type == ElementType::NON_TERMINAL) {
-                goto_table[stateId][transition.symbol] = transition.to_state;
-            } else {
-                applyShiftAction(stateId, transition, shift_reduce_conflicts, resolved_sr_conflicts);
-            }
+    for (const StateTransition& transition : transitions) {
+        if (g.isNonTerminal(transition.symbol)) {
+            goto_table[transition.from_state][g.nonTerminalIndex(transition.symbol)] = transition.to_state;
+        } else {
+            applyShiftAction(transition.from_state, transition, shift_reduce_conflicts, resolved_sr_conflicts);
         }
     }
 
@@ -184,45 +287,25 @@ void LRGenerator::buildActionGotoTable()
 
 bool LRGenerator::isReduceItem(const LRItem& item) const
 {
-    return item.dot_position >= static_cast<int>(item.prod.right.size());
-}
-
-int LRGenerator::productionIndexOf(const LRItem& item) const
-{
-    const int candidateId = item.prod.id;
-    if (candidateId >= 0 && candidateId < static_cast<int>(parser.productions.size())) {
-        const Production& candidate = parser.productions[candidateId];
-        if (candidate.left.name == item.prod.left.name && candidate.right == item.prod.right) {
-            return candidateId;
-        }
-    }
-
-    for (size_t i = 0; i < parser.productions.size(); ++i) {
-        const Production& prod = parser.productions[i];
-        if (prod.left.name == item.prod.left.name && prod.right == item.prod.right) {
-            return static_cast<int>(i);
-        }
-    }
-
-    return -1;
+    return item.dot_position >= grammar->rightLength(item.prod);
 }
 
 bool LRGenerator::resolveReduceReduceConflict(int newProdIndex, ActionEntry& existingEntry, int& resolvedCount) const
 {
-    if (existingEntry.value < 0 || existingEntry.value >= static_cast<int>(parser.productions.size())) {
+    if (existingEntry.value < 0 || existingEntry.value >= static_cast<int>(grammar->productionCount())) {
         return false;
     }
 
-    const Production& currentProd = parser.productions[newProdIndex];
-    const Production& existingProd = parser.productions[existingEntry.value];
+    const int currentPrecedence = grammar->productionPrecedence(newProdIndex);
+    const int existingPrecedence = grammar->productionPrecedence(existingEntry.value);
 
-    if (currentProd.precedence > 0 && existingProd.precedence > 0) {
-        if (currentProd.precedence > existingProd.precedence) {
+    if (currentPrecedence > 0 && existingPrecedence > 0) {
+        if (currentPrecedence > existingPrecedence) {
             existingEntry = { ActionType::REDUCE, newProdIndex };
             resolvedCount++;
             return true;
         }
-        if (currentProd.precedence < existingProd.precedence) {
+        if (currentPrecedence < existingPrecedence) {
             resolvedCount++;
             return true;
         }
@@ -233,30 +316,27 @@ bool LRGenerator::resolveReduceReduceConflict(int newProdIndex, ActionEntry& exi
 
 bool LRGenerator::resolveShiftReduceConflict(int stateId, const StateTransition& transition, int reduceIndex, ActionEntry& existingEntry, int& resolvedCount) const
 {
-    if (reduceIndex < 0 || reduceIndex >= static_cast<int>(parser.productions.size())) {
+    if (reduceIndex < 0 || reduceIndex >= static_cast<int>(grammar->productionCount())) {
         return false;
     }
 
-    const Production& reduceProd = parser.productions[reduceIndex];
-    const Symbol& lookAhead = transition.symbol;
+    const int reducePrecedence = grammar->productionPrecedence(reduceIndex);
+    const SymbolId lookAhead = transition.symbol;
+    const int symbolPrecedence = grammar->precedence(lookAhead);
 
-    auto symbolIt = parser.symbol_table.find(lookAhead.name);
-    if (reduceProd.precedence > 0 && symbolIt != parser.symbol_table.end() && symbolIt->second.precedence > 0) {
-
-        const Symbol& conflictSymbol = symbolIt->second;
-
-        if (reduceProd.precedence > conflictSymbol.precedence) {
+    if (reducePrecedence > 0 && symbolPrecedence > 0) {
+        if (reducePrecedence > symbolPrecedence) {
             resolvedCount++;
             return true; // 保留规约
         }
 
-        if (reduceProd.precedence < conflictSymbol.precedence) {
+        if (reducePrecedence < symbolPrecedence) {
             existingEntry = { ActionType::SHIFT, transition.to_state };
             resolvedCount++;
             return true;
         }
 
-        switch (conflictSymbol.assoc) {
+        switch (grammar->associativity(lookAhead)) {
         case Associativity::LEFT:
             resolvedCount++;
             return true; // 左结合，选择规约
@@ -265,10 +345,10 @@ bool LRGenerator::resolveShiftReduceConflict(int stateId, const StateTransition&
             resolvedCount++;
             return true;
         case Associativity::NONASSOC:
-            existingEntry = { ActionType::ERROR, 0 };
+            existingEntry = { ActionType::ERROR, ActionEntry::kNonassoc };
             resolvedCount++;
-            std::cout << "无结合性操作符 (报错): 状态 " << stateId
-                      << ", 符号 " << lookAhead.name << std::endl;
+            *out_stream << "无结合性操作符 (报错): 状态 " << stateId
+                      << ", 符号 " << grammar->name(lookAhead) << std::endl;
             return true;
         default:
             break;
@@ -280,185 +360,239 @@ bool LRGenerator::resolveShiftReduceConflict(int stateId, const StateTransition&
 
 void LRGenerator::applyReduceAction(int stateId, const LRItem& item, int& conflictCount, int& resolvedCount)
 {
-    if (item.prod.left.name == "S'" && item.lookahead.name == "$") {
+    if (item.prod == 0 && item.lookahead == Grammar::kEndSymbol) {
         action_table[stateId][item.lookahead] = { ActionType::ACCEPT, 0 };
         return;
     }
 
-    const int prodIndex = productionIndexOf(item);
-    if (prodIndex < 0) {
-        std::cout << "  警告: 无法确定产生式索引: " << item.prod.left.name << " -> ";
-        if (item.prod.right.empty()) {
-            std::cout << "ε";
-        } else {
-            for (const Symbol& sym : item.prod.right) {
-                std::cout << sym.name << ' ';
-            }
-        }
-        std::cout << std::endl;
-        return;
-    }
-
-    auto& actions = action_table[stateId];
-    auto it = actions.find(item.lookahead);
-    if (it == actions.end()) {
-        actions[item.lookahead] = { ActionType::REDUCE, prodIndex };
+    const int prodIndex = static_cast<int>(item.prod);
+    ActionEntry& existingEntry = action_table[stateId][item.lookahead];
+    if (existingEntry.type == ActionType::ERROR) {
+        existingEntry = { ActionType::REDUCE, prodIndex };
         return;
     }
 
-    ActionEntry& existingEntry = it->second;
     if (existingEntry.type != ActionType::REDUCE) {
         return;
     }
 
     conflictCount++;
-
-    if (resolveReduceReduceConflict(prodIndex, existingEntry, resolvedCount)) {
-        return;
-    }
-
-    std::cout << "规约/规约冲突: 状态 " << stateId
-              << ", 符号 " << item.lookahead.name
-              << ", 产生式 " << prodIndex << " 和产生式 " << existingEntry.value << std::endl;
-
-    if (prodIndex < existingEntry.value) {
-        existingEntry = { ActionType::REDUCE, prodIndex };
+    const int previous = existingEntry.value;
+    const bool resolved = resolveReduceReduceConflict(prodIndex, existingEntry, resolvedCount);
+    if (!resolved) {
+        *out_stream << "规约/规约冲突: 状态 " << stateId
+                  << ", 符号 " << grammar->name(item.lookahead)
+                  << ", 产生式 " << prodIndex << " 和产生式 " << existingEntry.value << std::endl;
+
+        if (prodIndex < existingEntry.value) {
+            existingEntry = { ActionType::REDUCE, prodIndex };
+        }
     }
+    conflicts.push_back({ stateId, item.lookahead, previous, { ActionType::REDUCE, prodIndex }, existingEntry, resolved });
 }
 
 void LRGenerator::applyShiftAction(int stateId, const StateTransition& transition, int& conflictCount, int& resolvedCount)
 {
-    auto& actions = action_table[stateId];
-    auto it = actions.find(transition.symbol);
-    if (it == actions.end()) {
-        actions[transition.symbol] = { ActionType::SHIFT, transition.to_state };
+    ActionEntry& existingEntry = action_table[stateId][transition.symbol];
+    if (existingEntry.type == ActionType::ERROR) {
+        existingEntry = { ActionType::SHIFT, transition.to_state };
         return;
     }
 
-    ActionEntry& existingEntry = it->second;
     if (existingEntry.type != ActionType::REDUCE) {
         return;
     }
 
     conflictCount++;
-
-    if (resolveShiftReduceConflict(stateId, transition, existingEntry.value, existingEntry, resolvedCount)) {
-        return;
-    }
-
-    std::cout << "移入/规约冲突: 状态 " << stateId
-              << ", 符号 " << transition.symbol.name
-              << ", 移入到状态 " << transition.to_state
-              << " 或规约产生式 " << existingEntry.value << std::endl;
-
-    actions[transition.symbol] = { ActionType::SHIFT, transition.to_state };
+    const int previous = existingEntry.value;
+    const bool resolved = resolveShiftReduceConflict(stateId, transition, existingEntry.value, existingEntry, resolvedCount);
+    if (!resolved) {
+        *out_stream << "移入/规约冲突: 状态 " << stateId
+                  << ", 符号 " << grammar->name(transition.symbol)
+                  << ", 移入到状态 " << transition.to_state
+                  << " 或规约产生式 " << existingEntry.value << std::endl;
+
+        existingEntry = { ActionType::SHIFT, transition.to_state };
+    }
+    conflicts.push_back(
+        { stateId, transition.symbol, previous, { ActionType::SHIFT, transition.to_state }, existingEntry, resolved });
 }
 
 void LRGenerator::reportConflictStats(int shiftReduceConflicts, int resolvedSR, int reduceReduceConflicts, int resolvedRR) const
 {
-    std::cout << "\n==== 冲突统计 ====" << std::endl;
-    std::cout << "移入/规约冲突: " << shiftReduceConflicts << " 个，已解决: " << resolvedSR << " 个" << std::endl;
-    std::cout << "规约/规约冲突: " << reduceReduceConflicts << " 个，已解决: " << resolvedRR << " 个" << std::endl;
-    std::cout << "==================" << std::endl;
+    *out_stream << "\n==== 冲突统计 ====" << std::endl;
+    *out_stream << "移入/规约冲突: " << shiftReduceConflicts << " 个，已解决: " << resolvedSR << " 个" << std::endl;
+    *out_stream << "规约/规约冲突: " << reduceReduceConflicts << " 个，已解决: " << resolvedRR << " 个" << std::endl;
+    *out_stream << "==================" << std::endl;
 
     if (shiftReduceConflicts == resolvedSR && reduceReduceConflicts == resolvedRR) {
         if (shiftReduceConflicts > 0 || reduceReduceConflicts > 0) {
-            std::cout << "所有冲突已通过优先级和结合性规则解决！" << std::endl;
+            *out_stream << "所有冲突已通过优先级和结合性规则解决！" << std::endl;
         }
     }
 }
 
-ItemSet LRGenerator::computeClosure(const ItemSet& itemSet)
+void LRGenerator::computeClosure(ItemSet& itemSet) const
 {
-    ItemSet result = itemSet;
-    size_t index = 0;
+    const Grammar& g = *grammar;
 
-    while (index < result.items.size()) {
-        const LRItem& item = result.items[index++];
+    // 以 (产生式, 点号) 为核心合并向前看符号，核心的向前看集合变大时重新传播
+    struct Core {
+        ProductionId prod;
+        std::uint32_t dot;
+        bool queued;
+    };
+    std::vector<Core> cores;
+    std::vector<std::uint64_t> lookaheads;
+    std::vector<std::size_t> worklist;
+
+    // 核心在 cores 中的下标，按 item_offsets 给出的项编号直接寻址
+    std::vector<std::int32_t> coreIndex(item_offsets.back(), -1);
+
+    auto coreOf = [&](ProductionId prod, std::uint32_t dot) {
+        std::int32_t& slot = coreIndex[item_offsets[prod] + dot];
+        if (slot < 0) {
+            slot = static_cast<std::int32_t>(cores.size());
+            cores.push_back({ prod, dot, false });
+            lookaheads.resize(lookaheads.size() + terminal_words, 0);
+        }
+        return static_cast<std::size_t>(slot);
+    };
 
-        if (item.dot_position >= item.prod.right.size()) {
-            continue;
+    for (const LRItem& item : itemSet.items) {
+        const std::size_t index = coreOf(item.prod, item.dot_position);
+        lookaheads[index * terminal_words + item.lookahead / 64] |= std::uint64_t(1) << (item.lookahead % 64);
+        if (!cores[index].queued) {
+            cores[index].queued = true;
+            worklist.push_back(index);
         }
+    }
+
+    std::vector<std::uint64_t> propagated(terminal_words);
+    while (!worklist.empty()) {
+        const std::size_t index = worklist.back();
+        worklist.pop_back();
+        cores[index].queued = false;
 
-        const Symbol& nextSymbol = item.prod.right[item.dot_position];
-        if (nextSymbol.type != ElementType::NON_TERMINAL) {
+        const SymbolSpan rhs = g.right(cores[index].prod);
+        const std::uint32_t dot = cores[index].dot;
+        if (dot >= rhs.size() || g.isTerminal(rhs[dot])) {
             continue;
         }
 
-        std::vector<Symbol> betaA;
-        betaA.reserve(item.prod.right.size() - item.dot_position);
-        betaA.insert(betaA.end(), item.prod.right.begin() + item.dot_position + 1, item.prod.right.end());
-        betaA.push_back(item.lookahead);
-
-        std::unordered_set<Symbol, SymbolHasher> firstSet = computeFirstOfSequence(betaA);
+        // 新项的向前看集合为 FIRST(β a)
+        std::fill(propagated.begin(), propagated.end(), 0);
+        if (addFirstOfSequence(rhs.begin() + dot + 1, rhs.end(), propagated.data())) {
+            orInto(propagated.data(), &lookaheads[index * terminal_words], terminal_words);
+        }
 
-        bool matchedProduction = false;
-        for (const Production& p : parser.productions) {
-            if (p.left.name != nextSymbol.name) {
-                continue;
+        const SymbolId next = rhs[dot];
+        for (const ProductionId* p = g.productionsOfBegin(next); p != g.productionsOfEnd(next); ++p) {
+            const std::size_t target = coreOf(*p, 0);
+            if (orInto(&lookaheads[target * terminal_words], propagated.data(), terminal_words) && !cores[target].queued) {
+                cores[target].queued = true;
+                worklist.push_back(target);
             }
+        }
+    }
 
-            matchedProduction = true;
-
-            for (const Symbol& lookahead : firstSet) {
-                LRItem newItem { p, 0, lookahead };
+    // 按 (产生式, 点号) 排序核心，每个核心的向前看符号从位集中按升序取出，结果即为有序项集
+    std::vector<std::size_t> order(cores.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&cores](std::size_t a, std::size_t b) {
+        return cores[a].prod != cores[b].prod ? cores[a].prod < cores[b].prod : cores[a].dot < cores[b].dot;
+    });
 
-                if (std::find(result.items.begin(), result.items.end(), newItem) == result.items.end()) {
-                    result.items.push_back(newItem);
-                }
+    itemSet.items.clear();
+    for (std::size_t i : order) {
+        for (std::size_t w = 0; w < terminal_words; ++w) {
+            std::uint64_t bits = lookaheads[i * terminal_words + w];
+            while (bits != 0) {
+                const unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+                itemSet.items.push_back({ cores[i].prod, cores[i].dot, static_cast<SymbolId>(w * 64 + bit) });
             }
         }
-
-        if (!matchedProduction) {
-            std::cout << "    警告: 没有找到非终结符 " << nextSymbol.name << " 的产生式!" << std::endl;
-        }
     }
-    return result;
 }
 
-ItemSet LRGenerator::computeGoto(const ItemSet& itemSet, const Symbol& symbol)
+void LRGenerator::buildCanonicalCollection()
 {
-    ItemSet resultSet;
-
-    for (const LRItem& item : itemSet.items) {
-        // 如果点号后面是要查找的符号
-        if (item.dot_position < item.prod.right.size() && item.prod.right[item.dot_position].name == symbol.name && item.prod.right[item.dot_position].type == symbol.type) {
+    const Grammar& g = *grammar;
+    transitions.clear();
+    canonical_collection.clear();
 
-            // 创建新项，将点号向右移动一位
-            LRItem newItem = item;
-            newItem.dot_position++;
-            resultSet.items.push_back(newItem);
-        }
+    // 为每个 (产生式, 点号) 分配连续编号，闭包计算时用数组代替哈希表
+    item_offsets.assign(g.productionCount() + 1, 0);
+    for (ProductionId prod = 0; prod < g.productionCount(); ++prod) {
+        item_offsets[prod + 1] = item_offsets[prod] + g.rightLength(prod) + 1;
     }
 
-    // 如果resultSet不为空，计算其闭包
-    if (!resultSet.items.empty()) {
-        return computeClosure(resultSet);
-    }
+    // 初始项集: S' -> · start, $
+    ItemSet initialItemSet;
+    initialItemSet.items.push_back({ 0, 0, Grammar::kEndSymbol });
+    initialItemSet.state_id = 0;
 
-    return resultSet;
-}
+    std::unordered_map<std::vector<LRItem>, int, KernelHasher> stateByKernel;
+    stateByKernel.emplace(initialItemSet.items, 0);
 
-void LRGenerator::addAugmentedProduction()
-{
-    Symbol& newStart = parser.ensureSymbol("S'", ElementType::NON_TERMINAL);
+    computeClosure(initialItemSet);
+    canonical_collection.push_back(std::move(initialItemSet));
 
-    Production augmentedProd;
-    augmentedProd.left = newStart;
+    // 使用工作表算法构建项集规范族
+    std::vector<int> worklist = { 0 };
+    std::vector<std::vector<LRItem>> kernels(g.symbolCount());
+    std::vector<SymbolId> nextSymbols;
 
-    Symbol& originalStart = parser.ensureSymbol(parser.start_symbol, ElementType::NON_TERMINAL);
-    augmentedProd.right.push_back(originalStart);
+    while (!worklist.empty()) {
+        const int current = worklist.back();
+        worklist.pop_back();
 
-    parser.productions.insert(parser.productions.begin(), augmentedProd);
+        // 按点号后的符号对项分组，点号右移后即为GOTO的核心项（保持有序）
+        nextSymbols.clear();
+        for (const LRItem& item : canonical_collection[current].items) {
+            const SymbolSpan rhs = g.right(item.prod);
+            if (item.dot_position >= rhs.size()) {
+                continue;
+            }
+            const SymbolId X = rhs[item.dot_position];
+            if (kernels[X].empty()) {
+                nextSymbols.push_back(X);
+            }
+            kernels[X].push_back({ item.prod, item.dot_position + 1, item.lookahead });
+        }
+        std::sort(nextSymbols.begin(), nextSymbols.end());
+
+        for (SymbolId X : nextSymbols) {
+            auto [it, inserted] = stateByKernel.emplace(std::move(kernels[X]), 0);
+            kernels[X].clear();
+
+            if (inserted) {
+                ItemSet gotoSet;
+                gotoSet.items = it->first;
+                gotoSet.state_id = static_cast<int>(canonical_collection.size());
+                it->second = gotoSet.state_id;
+                computeClosure(gotoSet);
+                canonical_collection.push_back(std::move(gotoSet));
+                worklist.push_back(it->second);
+            }
 
-    for (size_t i = 0; i < parser.productions.size(); ++i) {
-        parser.productions[i].id = static_cast<int>(i);
+            transitions.push_back({ current, it->second, X });
+        }
     }
+
+    *out_stream << "规范项集族构建完成, 共 " << canonical_collection.size() << " 个状态, "
+              << transitions.size() << " 个转移" << std::endl;
 }
 
 // 处理语义动作中的 $$ 和 $N 替换
-std::string LRGenerator::processSemanticAction(const std::string& action, const Production& prod) const
+std::string LRGenerator::processSemanticAction(const std::string& action, ProductionId prod) const
 {
+    const Grammar& g = *grammar;
+    const SymbolSpan rhs = g.right(prod);
+
     if (action.empty()) {
         return "/* 无语义动作 */";
     }
@@ -472,8 +606,8 @@ std::string LRGenerator::processSemanticAction(const std::string& action, const
         std::string replacement = "yyval";
 
         // 如果非终结符有类型信息，添加适当的成员访问
-        if (!prod.left.value_type.empty()) {
-            replacement += "." + prod.left.value_type;
+        if (!g.valueType(g.left(prod)).empty()) {
+            replacement += "." + g.valueType(g.left(prod));
         }
 
         processed.replace(pos, 2, replacement);
@@ -498,14 +632,15 @@ std::string LRGenerator::processSemanticAction(const std::string& action, const
             int index = std::stoi(num);
 
             // 确保索引有效
-            if (index > 0 && index <= prod.right.size()) {
-                // 关键修改: 使用正确的索引对应关系
-                std::string replacement = "yyvsp[" + num + "]";
+            if (index > 0 && index <= static_cast<int>(rhs.size())) {
+                // 规约时 yysp 指向右部最后一个符号，$N 在栈中的偏移为 N - 右部长度
+                std::string replacement
+                    = "yysp[" + std::to_string(index - static_cast<int>(rhs.size())) + "].value";
 
                 // 如果对应的符号有类型信息，添加适当的成员访问
-                const Symbol& sym = prod.right[index - 1];
-                if (!sym.value_type.empty()) {
-                    replacement += "." + sym.value_type;
+                const std::string& valueType = g.valueType(rhs[index - 1]);
+                if (!valueType.empty()) {
+                    replacement += "." + valueType;
                 }
 
                 processed.replace(start, num.length() + 1, replacement);
@@ -519,10 +654,352 @@ std::string LRGenerator::processSemanticAction(const std::string& action, const
     return processed;
 }
 
+// 导出编码后的分析表
+ParseTables LRGenerator::exportTables(UnitRuleStats* stats) const
+{
+    return buildTables(eliminate_unit_rules, stats);
+}
+
+ParseTables LRGenerator::exportHostTables() const
+{
+    return buildTables(false, nullptr);
+}
+
+ParseTables LRGenerator::buildTables(bool eliminate, UnitRuleStats* stats) const
+{
+    const Grammar& g = *grammar;
+    ParseTables tables;
+
+    tables.state_count = static_cast<int>(canonical_collection.size());
+    tables.token_count = static_cast<int>(g.terminalCount());
+    tables.nonterminal_count = static_cast<int>(g.nonTerminalCount());
+
+    // 词法返回值到终结符编号的映射
+    // 单字符字面量与具名终结符的编码是稠密的，只有多字符字面量可能远大于它们
+    std::vector<int> rawTokenValues = computeRawTokenValues();
+    int denseLimit = 256;
+    for (SymbolId i = 0; i < g.terminalCount(); ++i) {
+        tables.max_user_token = std::max(tables.max_user_token, rawTokenValues[i]);
+        if (g.kind(i) != ElementType::LITERAL) {
+            denseLimit = std::max(denseLimit, rawTokenValues[i] + 1);
+        }
+    }
+
+    // 直接数组超过稠密范围的两倍时，所有编码改存稀疏表
+    const int directSize = tables.max_user_token + 1 > 2 * denseLimit ? 0 : tables.max_user_token + 1;
+    tables.translate.assign(directSize, -1);
+    for (size_t i = 0; i < rawTokenValues.size(); ++i) {
+        if (rawTokenValues[i] < directSize) {
+            tables.translate[rawTokenValues[i]] = static_cast<int>(i);
+        } else {
+            tables.sparse_translate.emplace_back(rawTokenValues[i], static_cast<int>(i));
+        }
+    }
+    std::sort(tables.sparse_translate.begin(), tables.sparse_translate.end());
+
+    // 编码动作:
+    // 正数 = 移入并转到该状态
+    // 负数 = 按照产生式规约 (-规则号-1)
+    // 0 = 接受
+    tables.action.reserve(static_cast<size_t>(tables.state_count) * tables.token_count);
+    for (const auto& row : action_table) {
+        for (const ActionEntry& entry : row) {
+            switch (entry.type) {
+            case ActionType::SHIFT:
+                tables.action.push_back(entry.value);
+                break;
+            case ActionType::REDUCE:
+                tables.action.push_back(-entry.value - 1);
+                break;
+            case ActionType::ACCEPT:
+                tables.action.push_back(0);
+                break;
+            default: // ERROR
+                tables.action.push_back(ParseTables::kErrorAction);
+            }
+        }
+    }
+
+    // 默认规约 (yydefact): 每个状态取出现次数最多的规约
+    // 该状态上的错误表项也按默认规约处理，错误会在下一次移入之前被发现；
+    // 含 %nonassoc 显式错误的状态不设默认规约，以免把错误变成规约
+    tables.default_reduction.assign(tables.state_count, 0);
+    std::vector<int> reduceCounts(g.productionCount());
+    for (int state = 0; state < tables.state_count; ++state) {
+        std::fill(reduceCounts.begin(), reduceCounts.end(), 0);
+        bool explicitError = false;
+        for (const ActionEntry& entry : action_table[state]) {
+            if (entry.type == ActionType::REDUCE) {
+                reduceCounts[entry.value]++;
+            } else if (entry.type == ActionType::ERROR && entry.value == ActionEntry::kNonassoc) {
+                explicitError = true;
+            }
+        }
+        if (explicitError) {
+            continue;
+        }
+        auto best = std::max_element(reduceCounts.begin(), reduceCounts.end());
+        if (*best > 0) {
+            tables.default_reduction[state] = static_cast<int>(best - reduceCounts.begin()) + 1;
+        }
+    }
+
+    tables.goto_table.reserve(static_cast<size_t>(tables.state_count) * tables.nonterminal_count);
+    for (const auto& row : goto_table) {
+        tables.goto_table.insert(tables.goto_table.end(), row.begin(), row.end());
+    }
+
+    // 非终结符编号从YYNTOKENS开始，增广起始符号记为0
+    for (ProductionId prod = 0; prod < g.productionCount(); ++prod) {
+        const SymbolId left = g.left(prod);
+        tables.rule_lhs.push_back(left != g.augmentedStart() ? static_cast<int>(left) : 0);
+        tables.rule_length.push_back(static_cast<int>(g.rightLength(prod)));
+    }
+
+    for (SymbolId terminal = 0; terminal < g.terminalCount(); ++terminal) {
+        tables.token_names.push_back(g.name(terminal));
+    }
+    for (SymbolId index = 0; index < g.nonTerminalCount(); ++index) {
+        tables.nonterminal_names.push_back(g.name(g.terminalCount() + index));
+    }
+
+    if (eliminate) {
+        std::vector<bool> eliminable(g.productionCount());
+        for (ProductionId prod = 0; prod < g.productionCount(); ++prod) {
+            eliminable[prod] = isEliminableUnitRule(prod);
+        }
+        tables = eliminateUnitRules(tables, eliminable, stats);
+    }
+
+    // 按访问的局部性重新编号，让一起使用的状态的表项相邻
+    if (state_order != StateOrder::CANONICAL) {
+        tables = renumberStates(tables, computeStateOrder(tables, state_order, state_profile));
+    }
+
+    return tables;
+}
+
+bool LRGenerator::isEliminableUnitRule(ProductionId prod) const
+{
+    const Grammar& g = *grammar;
+    if (prod == 0 || g.rightLength(prod) != 1) {
+        return false;
+    }
+
+    // 去掉空白后动作为空或只有 $$=$1
+    std::string action;
+    for (char c : g.semanticAction(prod)) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            action.push_back(c);
+        }
+    }
+    if (action.empty() || action == "{}") {
+        return true;
+    }
+    // 显式的 $$=$1 按 %type 做赋值转换，只有左右两边类型相同时才等同于直接传递语义值
+    return (action == "{$$=$1;}" || action == "{$$=$1}") && g.valueType(g.left(prod)) == g.valueType(g.right(prod)[0]);
+}
+
+// 按当前的表存储方式输出 ACTION/GOTO 表及其查表函数 yy_action/yy_goto
+void LRGenerator::emitParseTables(std::ostream& ss, const ParseTables& tables, std::ostream* definitions) const
+{
+    // 生成的各数组占用的字节数，用于和稠密表比较
+    std::size_t tableBytes = 0;
+
+    auto emitArray = [this, &ss, &tableBytes, definitions](const char* name, const std::vector<int>& values) {
+        emitTableArray(ss, name, values, tableBytes, output_threads.get(), 0, definitions);
+    };
+
+    ss << "/* 解析表 (" << tableModeName(table_mode) << ") */\n";
+    // 错误编码取比所有规约编码都小的值，与状态号、规则号一起决定表的元素类型
+    const int errorCode = tables.errorCode();
+    ss << "#define YYERRACT " << errorCode << "\n\n";
+
+    ss << "/* 每个状态的默认规约: 规则号+1，0 表示没有默认规约 */\n";
+    emitArray("yydefact", tables.default_reduction);
+
+    if (table_mode == TableMode::DENSE) {
+        ss << "#define YYLAST " << (tables.state_count * tables.token_count) << "\n\n";
+
+        // 生成动作表
+        std::vector<int> action = tables.action;
+        std::replace(action.begin(), action.end(), ParseTables::kErrorAction, errorCode);
+        emitTableArray(ss, "yytable", action, tableBytes, output_threads.get(), tables.token_count, definitions);
+
+        // 生成GOTO表，-1 表示无效状态
+        emitTableArray(ss, "yygoto", tables.goto_table, tableBytes, output_threads.get(), tables.nonterminal_count, definitions);
+
+        ss << "static inline int yy_action(int state, int token) {\n";
+        ss << "  return yytable[state * YYNTOKENS + token];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_goto(int state, int nonterminal) {\n";
+        ss << "  return yygoto[state * YYNNTS + nonterminal];\n";
+        ss << "}\n\n";
+
+        // 只有默认规约的状态
+        std::vector<int> defaultOnly(tables.state_count);
+        for (int state = 0; state < tables.state_count; ++state) {
+            defaultOnly[state] = tables.defaultOnly(state) ? 1 : 0;
+        }
+        ss << "/* 为1时该状态只有默认规约，无需读入向前看符号 */\n";
+        emitArray("yydefonly", defaultOnly);
+
+        ss << "static inline int yy_default_only(int state) {\n";
+        ss << "  return yydefonly[state];\n";
+        ss << "}\n\n";
+    } else if (table_mode == TableMode::ROWS) {
+        // 相同的ACTION行只存一份，GOTO列存默认目标与例外
+        const RowTables rows = compressRows(tables);
+
+        ss << "#define YYNROWS " << rows.rowCount() << "\n\n";
+
+        ss << "/* 每个状态的ACTION行号，第0行为空行 */\n";
+        emitArray("yyrowidx", rows.row_index);
+        std::vector<int> actionRows = rows.rows;
+        std::replace(actionRows.begin(), actionRows.end(), ParseTables::kErrorAction, errorCode);
+        ss << "/* 去重后的ACTION行 */\n";
+        emitArray("yyactrows", actionRows);
+        ss << "/* 每个非终结符的默认GOTO目标 */\n";
+        emitArray("yydefgoto", rows.default_goto);
+        ss << "/* 非终结符的GOTO例外为 yygotoidx[n] 到 yygotoidx[n + 1] 之间的表项，按状态升序 */\n";
+        emitArray("yygotoidx", rows.goto_offsets);
+        emitArray("yygotostate", rows.goto_states);
+        emitArray("yygototarget", rows.goto_targets);
+
+        ss << "static inline int yy_action(int state, int token) {\n";
+        ss << "  return yyactrows[yyrowidx[state] * YYNTOKENS + token];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_goto(int state, int nonterminal) {\n";
+        ss << "  int lo = yygotoidx[nonterminal];\n";
+        ss << "  int hi = yygotoidx[nonterminal + 1];\n";
+        ss << "  while (lo < hi) {\n";
+        ss << "    int mid = (lo + hi) / 2;\n";
+        ss << "    if (yygotostate[mid] == state) {\n";
+        ss << "      return yygototarget[mid];\n";
+        ss << "    }\n";
+        ss << "    if (yygotostate[mid] < state) {\n";
+        ss << "      lo = mid + 1;\n";
+        ss << "    } else {\n";
+        ss << "      hi = mid;\n";
+        ss << "    }\n";
+        ss << "  }\n";
+        ss << "  return yydefgoto[nonterminal];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_default_only(int state) {\n";
+        ss << "  return yyrowidx[state] == 0;\n";
+        ss << "}\n\n";
+    } else if (table_mode == TableMode::COLOR) {
+        // 图着色: 兼容的行与列合并，位图判定表项是否有效
+        const ColorTables color = compressColor(tables);
+
+        ss << "#define YYNACTCOLS " << color.action_columns << "\n";
+        ss << "#define YYNGOTOCOLS " << color.goto_columns << "\n";
+        ss << "#define YYBITMAPBYTES " << color.bitmap_bytes << "\n\n";
+
+        ss << "/* ACTION: 状态的行类、终结符的列类与合并后的矩阵 */\n";
+        emitArray("yyactrowcls", color.action_row_class);
+        emitArray("yyactcolcls", color.action_column_class);
+        emitArray("yyactmat", color.action_matrix);
+
+        ss << "/* 每个状态的有效表项位图行号，第0行全为0 */\n";
+        emitArray("yybitrow", color.bitmap_row);
+        emitArray("yybitmap", std::vector<int>(color.bitmaps.begin(), color.bitmaps.end()));
+
+        ss << "/* GOTO: 状态的行类、非终结符的列类与合并后的矩阵 */\n";
+        emitArray("yygotorowcls", color.goto_row_class);
+        emitArray("yygotocolcls", color.goto_column_class);
+        emitArray("yygotomat", color.goto_matrix);
+
+        ss << "static inline int yy_action(int state, int token) {\n";
+        ss << "  if (!(yybitmap[yybitrow[state] * YYBITMAPBYTES + token / 8] >> (token % 8) & 1)) {\n";
+        ss << "    return YYERRACT;\n";
+        ss << "  }\n";
+        ss << "  return yyactmat[yyactrowcls[state] * YYNACTCOLS + yyactcolcls[token]];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_goto(int state, int nonterminal) {\n";
+        ss << "  return yygotomat[yygotorowcls[state] * YYNGOTOCOLS + yygotocolcls[nonterminal]];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_default_only(int state) {\n";
+        ss << "  return yybitrow[state] == 0;\n";
+        ss << "}\n\n";
+    } else {
+        // 行位移压缩: ACTION 行与 GOTO 列共用 yytable/yycheck
+        const CombTables comb = compressComb(tables);
+
+        ss << "#define YYLAST " << (static_cast<int>(comb.table.size()) - 1) << "\n";
+        ss << "#define YYPACT_NINF " << comb.base_ninf << "\n\n";
+
+        ss << "/* 每个状态的ACTION行在 yytable 中的基址 */\n";
+        emitArray("yypact", comb.pact);
+        ss << "/* 每个非终结符的GOTO列在 yytable 中的基址 */\n";
+        emitArray("yypgoto", comb.pgoto);
+        ss << "/* 压缩后的表项，yycheck 记录表项所属的终结符或状态 */\n";
+        emitArray("yytable", comb.table);
+        emitArray("yycheck", comb.check);
+
+        ss << "static inline int yy_action(int state, int token) {\n";
+        ss << "  int yyn = yypact[state];\n";
+        ss << "  if (yyn == YYPACT_NINF) {\n";
+        ss << "    return YYERRACT;\n";
+        ss << "  }\n";
+        ss << "  yyn += token;\n";
+        ss << "  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != token) {\n";
+        ss << "    return YYERRACT;\n";
+        ss << "  }\n";
+        ss << "  return yytable[yyn];\n";
+        ss << "}\n\n";
+
+        ss << "static inline int yy_goto(int state, int nonterminal) {\n";
+        ss << "  int yyn = yypgoto[nonterminal];\n";
+        ss << "  if (yyn == YYPACT_NINF) {\n";
+        ss << "    return -1;\n";
+        ss << "  }\n";
+        ss << "  yyn += state;\n";
+        ss << "  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != state) {\n";
+        ss << "    return -1;\n";
+        ss << "  }\n";
+        ss << "  return yytable[yyn];\n";
+        ss << "}\n\n";
+
+        // 默认规约之外没有表项的状态，其ACTION行为空
+        ss << "static inline int yy_default_only(int state) {\n";
+        ss << "  return yypact[state] == YYPACT_NINF;\n";
+        ss << "}\n\n";
+    }
+
+    // 与全部用 short 存放的稠密表比较
+    const std::size_t denseBytes = (tables.action.size() + tables.goto_table.size()) * sizeof(short);
+    *out_stream << "分析表大小 (" << tableModeName(table_mode) << "): 稠密表 " << denseBytes
+                << " 字节 -> " << tableBytes << " 字节" << std::endl;
+}
+
 // 生成语法分析器代码
-std::string LRGenerator::generateParserCode(const std::string& filename) const
+std::string LRGenerator::generateParserCode(const std::string& filename, std::string* tables_source) const
 {
-    std::stringstream ss;
+    std::ostringstream ss;
+    std::ostringstream tableDefs;
+    writeParserCode(ss, filename, tables_source != nullptr ? &tableDefs : nullptr);
+    if (tables_source != nullptr) {
+        *tables_source = tableDefs.str();
+    }
+    return ss.str();
+}
+
+void LRGenerator::writeParserCode(std::ostream& ss, const std::string& filename, std::ostream* definitions) const
+{
+    const Grammar& g = *grammar;
+    // 可重入解析器的错误表与词法信息都在调用者提供的上下文 yyctx 中
+    const bool pure = g.pureParser();
+    const std::string errs = pure ? "yyctx->" : "";
+    if (definitions != nullptr) {
+        *definitions << "/* 由 SeuYacc 生成的分析表，与 " << filename << " 一起编译链接 */\n\n";
+        *definitions << kTableTypedefs;
+    }
 
     // 添加头部注释和包含文件
     ss << "/* 由 SeuYacc 生成的 LR(1) 解析器 */\n\n";
@@ -543,25 +1020,29 @@ std::string LRGenerator::generateParserCode(const std::string& filename) const
 
     // 添加错误收集结构
     ss << "/* 错误收集功能 */\n";
-    ss << "typedef struct ErrorInfo {\n";
-    ss << "    int line;\n";
-    ss << "    char* message;\n";
-    ss << "    char* actual_token;\n";
-    ss << "    char** expected_tokens;\n";
-    ss << "    int expected_count;\n";
-    ss << "} ErrorInfo;\n\n";
-    
-    ss << "static ErrorInfo* errors = NULL;\n";
-    ss << "static int error_count = 0;\n";
-    ss << "static int error_capacity = 0;\n\n";
-    
-    ss << "static void add_error(int line, const char* msg, const char* actual, \n";
+    if (pure) {
+        ss << "typedef yyparse_error ErrorInfo;\n\n";
+    } else {
+        ss << "typedef struct ErrorInfo {\n";
+        ss << "    int line;\n";
+        ss << "    char* message;\n";
+        ss << "    char* actual_token;\n";
+        ss << "    char** expected_tokens;\n";
+        ss << "    int expected_count;\n";
+        ss << "} ErrorInfo;\n\n";
+
+        ss << "static ErrorInfo* errors = NULL;\n";
+        ss << "static int error_count = 0;\n";
+        ss << "static int error_capacity = 0;\n\n";
+    }
+
+    ss << "static void add_error(" << (pure ? "yyparse_ctx* yyctx, " : "") << "int line, const char* msg, const char* actual, \n";
     ss << "                     const char** expected, int exp_count) {\n";
-    ss << "    if (error_count >= error_capacity) {\n";
-    ss << "        error_capacity = error_capacity == 0 ? 10 : error_capacity * 2;\n";
-    ss << "        errors = (ErrorInfo*)realloc(errors, error_capacity * sizeof(ErrorInfo));\n";
+    ss << "    if (" << errs << "error_count >= " << errs << "error_capacity) {\n";
+    ss << "        " << errs << "error_capacity = " << errs << "error_capacity == 0 ? 10 : " << errs << "error_capacity * 2;\n";
+    ss << "        " << errs << "errors = (ErrorInfo*)realloc(" << errs << "errors, " << errs << "error_capacity * sizeof(ErrorInfo));\n";
     ss << "    }\n";
-    ss << "    ErrorInfo* err = &errors[error_count];\n";
+    ss << "    ErrorInfo* err = &" << errs << "errors[" << errs << "error_count];\n";
     ss << "    err->line = line;\n";
     ss << "    err->message = strdup(msg);\n";
     ss << "    err->actual_token = actual ? strdup(actual) : NULL;\n";
@@ -574,583 +1055,793 @@ std::string LRGenerator::generateParserCode(const std::string& filename) const
     ss << "    } else {\n";
     ss << "        err->expected_tokens = NULL;\n";
     ss << "    }\n";
-    ss << "    error_count++;\n";
+    ss << "    " << errs << "error_count++;\n";
     ss << "}\n\n";
-    
-    ss << "static void print_errors_json(void) {\n";
-    ss << "    printf(\"{\\n\");\n";
-    ss << "    printf(\"  \\\"errors\\\": [\\n\");\n";
-    ss << "    for (int i = 0; i < error_count; i++) {\n";
-    ss << "        ErrorInfo* err = &errors[i];\n";
-    ss << "        printf(\"    {\\n\");\n";
-    ss << "        printf(\"      \\\"line\\\": %d,\\n\", err->line);\n";
-    ss << "        printf(\"      \\\"message\\\": \\\"%s\\\",\\n\", err->message);\n";
+
+    if (pure) {
+        ss << "void yyparse_ctx_print_errors(const yyparse_ctx* yyctx, FILE* out) {\n";
+    } else {
+        ss << "static void print_errors_json(FILE* out) {\n";
+    }
+    ss << "    fprintf(out, \"{\\n\");\n";
+    ss << "    fprintf(out, \"  \\\"errors\\\": [\\n\");\n";
+    ss << "    for (int i = 0; i < " << errs << "error_count; i++) {\n";
+    ss << "        const ErrorInfo* err = &" << errs << "errors[i];\n";
+    ss << "        fprintf(out, \"    {\\n\");\n";
+    ss << "        fprintf(out, \"      \\\"line\\\": %d,\\n\", err->line);\n";
+    ss << "        fprintf(out, \"      \\\"message\\\": \\\"%s\\\",\\n\", err->message);\n";
     ss << "        if (err->actual_token) {\n";
-    ss << "            printf(\"      \\\"actual\\\": \\\"%s\\\",\\n\", err->actual_token);\n";
+    ss << "            fprintf(out, \"      \\\"actual\\\": \\\"%s\\\",\\n\", err->actual_token);\n";
     ss << "        }\n";
-    ss << "        printf(\"      \\\"expected\\\": [\");\n";
+    ss << "        fprintf(out, \"      \\\"expected\\\": [\");\n";
     ss << "        for (int j = 0; j < err->expected_count; j++) {\n";
-    ss << "            printf(\"\\\"%s\\\"\", err->expected_tokens[j]);\n";
-    ss << "            if (j < err->expected_count - 1) printf(\", \");\n";
+    ss << "            fprintf(out, \"\\\"%s\\\"\", err->expected_tokens[j]);\n";
+    ss << "            if (j < err->expected_count - 1) fprintf(out, \", \");\n";
     ss << "        }\n";
-    ss << "        printf(\"]\\n\");\n";
-    ss << "        printf(\"    }%s\\n\", i < error_count - 1 ? \",\" : \"\");\n";
+    ss << "        fprintf(out, \"]\\n\");\n";
+    ss << "        fprintf(out, \"    }%s\\n\", i < " << errs << "error_count - 1 ? \",\" : \"\");\n";
     ss << "    }\n";
-    ss << "    printf(\"  ],\\n\");\n";
-    ss << "    printf(\"  \\\"errorCount\\\": %d\\n\", error_count);\n";
-    ss << "    printf(\"}\\n\");\n";
+    ss << "    fprintf(out, \"  ],\\n\");\n";
+    ss << "    fprintf(out, \"  \\\"errorCount\\\": %d\\n\", " << errs << "error_count);\n";
+    ss << "    fprintf(out, \"}\\n\");\n";
     ss << "}\n\n";
 
+    if (pure) {
+        // 上下文的初始化、复用与释放
+        ss << "void yyparse_ctx_init(yyparse_ctx* yyctx, void* user) {\n";
+        ss << "    memset(yyctx, 0, sizeof(*yyctx));\n";
+        ss << "    yyctx->user = user;\n";
+        ss << "    yyctx->lineno = 1;\n";
+        ss << "}\n\n";
+        ss << "void yyparse_ctx_reset(yyparse_ctx* yyctx) {\n";
+        ss << "    for (int i = 0; i < yyctx->error_count; i++) {\n";
+        ss << "        ErrorInfo* err = &yyctx->errors[i];\n";
+        ss << "        for (int j = 0; j < err->expected_count; j++) {\n";
+        ss << "            free(err->expected_tokens[j]);\n";
+        ss << "        }\n";
+        ss << "        free(err->expected_tokens);\n";
+        ss << "        free(err->message);\n";
+        ss << "        free(err->actual_token);\n";
+        ss << "    }\n";
+        ss << "    yyctx->error_count = 0;\n";
+        ss << "    yyctx->lineno = 1;\n";
+        ss << "    yyctx->text = NULL;\n";
+        ss << "}\n\n";
+        ss << "void yyparse_ctx_destroy(yyparse_ctx* yyctx) {\n";
+        ss << "    yyparse_ctx_reset(yyctx);\n";
+        ss << "    free(yyctx->errors);\n";
+        ss << "    yyctx->errors = NULL;\n";
+        ss << "    yyctx->error_capacity = 0;\n";
+        ss << "}\n\n";
+    }
+
     // 添加用户声明代码块
-    if (!parser.declaration_code.empty()) {
+    if (!g.declarationCode().empty()) {
         ss << "/* 用户声明代码 */\n";
-        ss << parser.declaration_code << "\n\n";
+        ss << g.declarationCode() << "\n\n";
     }
 
-    std::vector<Symbol> terminals = getSortedTerminals();
-    std::vector<Symbol> nonTerminals = getSortedNonTerminals();
-    std::vector<int> rawTokenValues = computeRawTokenValues(terminals);
-
-    int yymaxutok = 0;
-    for (int value : rawTokenValues) {
-        if (value > yymaxutok) {
-            yymaxutok = value;
-        }
+    UnitRuleStats unitStats;
+    ParseTables tables = exportTables(&unitStats);
+    if (eliminate_unit_rules) {
+        *out_stream << "单元规约消除: 改向 " << unitStats.redirected << " 个转移, 新增 " << unitStats.merged_states
+                    << " 个合并状态, 删除 " << unitStats.removed_states << " 个不可达状态, 共 " << tables.state_count
+                    << " 个状态" << std::endl;
     }
-
-    std::vector<int> translateTable(yymaxutok + 1, -1);
-    for (size_t i = 0; i < rawTokenValues.size(); ++i) {
-        translateTable[rawTokenValues[i]] = static_cast<int>(i);
+    if (shift_reduce) {
+        int fusedStates = 0;
+        tables = fuseShiftReduce(tables, &fusedStates);
+        *out_stream << "移入-规约合并: 合并 " << fusedStates << " 个规约状态, 共 " << tables.state_count << " 个状态"
+                    << std::endl;
     }
+    const int yymaxutok = tables.max_user_token;
 
     // 添加全局变量定义
-    ss << "/* 全局变量定义 */\n";
-    ss << "YYSTYPE yylval;\n\n";
+    if (!pure) {
+        ss << "/* 全局变量定义 */\n";
+        ss << "YYSTYPE yylval;\n\n";
+    }
 
     // 添加解析器内部定义和宏
     ss << "/* 解析器内部定义 */\n";
+    ss << "/* 分析栈先使用 yyparse 内 YYINITDEPTH 层的数组，满后在堆上按倍数扩大，超过 YYMAXDEPTH 层时报错 */\n";
+    ss << "#ifndef YYINITDEPTH\n";
+    ss << "# define YYINITDEPTH 64\n";
+    ss << "#endif\n";
     ss << "#ifndef YYMAXDEPTH\n";
-    ss << "# define YYMAXDEPTH 10000\n"; // 添加YYMAXDEPTH定义
+    ss << "# define YYMAXDEPTH 10000\n";
+    ss << "#endif\n";
+    ss << "#if YYMAXDEPTH < YYINITDEPTH\n";
+    ss << "# undef YYINITDEPTH\n";
+    ss << "# define YYINITDEPTH YYMAXDEPTH\n";
+    ss << "#endif\n";
+    ss << "/* 堆上分析栈的分配函数，可在编译时替换 */\n";
+    ss << "#ifndef YYMALLOC\n";
+    ss << "# define YYMALLOC malloc\n";
+    ss << "#endif\n";
+    ss << "#ifndef YYREALLOC\n";
+    ss << "# define YYREALLOC realloc\n";
+    ss << "#endif\n";
+    ss << "#ifndef YYFREE\n";
+    ss << "# define YYFREE free\n";
     ss << "#endif\n\n";
-    ss << "#define YYFINAL " << (canonical_collection.size() - 1) << "\n";
-    ss << "#define YYLAST " << (canonical_collection.size() * terminals.size()) << "\n\n";
-
-    ss << "#define YYNTOKENS " << terminals.size() << "\n";
-    ss << "#define YYNNTS " << nonTerminals.size() << "\n";
-    ss << "#define YYNRULES " << parser.productions.size() << "\n";
-    ss << "#define YYNSTATES " << canonical_collection.size() << "\n";
-    ss << "#define YYMAXUTOK " << yymaxutok << "\n";
-    ss << "#define YYUNDEF -1\n\n";
+    ss << "#define YYFINAL " << (tables.state_count - 1) << "\n\n";
 
-    ss << "static const short yytranslate_table[" << (yymaxutok + 1) << "] = {\n  ";
-    for (int i = 0; i <= yymaxutok; ++i) {
-        ss << translateTable[i];
-        if (i != yymaxutok) {
-            ss << ", ";
-        }
-        if ((i + 1) % 16 == 0 && i != yymaxutok) {
-            ss << "\n  ";
-        }
-    }
-    ss << "\n};\n\n";
+    // 调试跟踪: YYDEBUG 为 0 时跟踪代码全部编译掉
+    ss << "/* 调试跟踪: 以 -DYYDEBUG=1 编译后由 yydebug 控制, 1 输出读入的 token 与移入/规约, 2 另外输出查表与栈的细节 */\n";
+    ss << "#ifndef YYDEBUG\n";
+    ss << "# define YYDEBUG 0\n";
+    ss << "#endif\n";
+    ss << "#if YYDEBUG\n";
+    ss << "int yydebug;\n";
+    ss << "# ifndef YYFPRINTF\n";
+    ss << "#  define YYFPRINTF fprintf\n";
+    ss << "# endif\n";
+    ss << "# define YYDPRINTF(level, args) do { if (yydebug >= (level)) YYFPRINTF args; } while (0)\n";
+    ss << "#else\n";
+    ss << "# define YYDPRINTF(level, args) ((void) 0)\n";
+    ss << "#endif\n\n";
 
-    ss << "static inline int yytranslate_token(int token) {\n";
-    ss << "  if (token < 0 || token > YYMAXUTOK) {\n";
-    ss << "    return YYUNDEF;\n";
+    ss << "#if YYDEBUG && defined(YYTRACE_RING)\n";
+    ss << "/* 以 -DYYTRACE_RING=N 编译时（不受 yydebug 控制）在环形缓冲区中记录最近 N 个分析事件，\n";
+    ss << "   出错后可在调试器中查看 yytrace_ring，或调用 yytrace_dump 按时间顺序以二进制写出 */\n";
+    ss << "yytrace_event yytrace_ring[YYTRACE_RING];\n";
+    ss << "unsigned long yytrace_count; /* 已记录的事件总数 */\n";
+    ss << "# define YYTRACE(event_kind, event_state, event_value) do { \\\n";
+    ss << "    yytrace_event* yyevent = &yytrace_ring[yytrace_count++ % YYTRACE_RING]; \\\n";
+    ss << "    yyevent->kind = (event_kind); \\\n";
+    ss << "    yyevent->state = (event_state); \\\n";
+    ss << "    yyevent->value = (event_value); \\\n";
+    ss << "  } while (0)\n\n";
+    ss << "size_t yytrace_dump(FILE* out) {\n";
+    ss << "  unsigned long first = yytrace_count > YYTRACE_RING ? yytrace_count - YYTRACE_RING : 0;\n";
+    ss << "  size_t written = 0;\n";
+    ss << "  for (unsigned long i = first; i < yytrace_count; i++) {\n";
+    ss << "    written += fwrite(&yytrace_ring[i % YYTRACE_RING], sizeof(yytrace_event), 1, out);\n";
     ss << "  }\n";
-    ss << "  return yytranslate_table[token];\n";
-    ss << "}\n\n";
-
-    // 添加动作和状态转移表
-    ss << "/* 解析表 */\n";
-
-    // 生成动作表
-    ss << "static const short yytable[] = {\n";
-
-    for (int state = 0; state < canonical_collection.size(); ++state) {
-        ss << "  /* 状态 " << state << " */\n  ";
-        for (const auto& terminal : terminals) {
-            if (action_table.find(state) != action_table.end() && action_table.at(state).find(terminal) != action_table.at(state).end()) {
-
-                const ActionEntry& entry = action_table.at(state).at(terminal);
-
-                // 编码动作:
-                // 正数 = 移入并转到该状态
-                // 负数 = 按照产生式规约 (-规则号-1)
-                // 0 = 接受
-                int code;
-
-                switch (entry.type) {
-                case ActionType::SHIFT:
-                    code = entry.value;
-                    break;
-                case ActionType::REDUCE:
-                    code = -entry.value - 1;
-                    break;
-                case ActionType::ACCEPT:
-                    code = 0;
-                    break;
-                default: // ERROR
-                    code = -32767; // 表示错误
-                }
+    ss << "  return written;\n";
+    ss << "}\n";
+    ss << "#else\n";
+    ss << "# define YYTRACE(event_kind, event_state, event_value) ((void) 0)\n";
+    ss << "#endif\n\n";
 
-                ss << code << ", ";
-            } else {
-                // 错误
-                ss << "-32767, ";
-            }
-        }
-        ss << "\n";
+    ss << "#define YYNTOKENS " << tables.token_count << "\n";
+    ss << "#define YYNNTS " << tables.nonterminal_count << "\n";
+    ss << "#define YYNRULES " << g.productionCount() << "\n";
+    ss << "#define YYNSTATES " << tables.state_count << "\n";
+    ss << "#define YYMAXUTOK " << yymaxutok << "\n";
+    ss << "#define YYUNDEF -1\n";
+    ss << "#define YYEMPTY -2\n\n";
+
+    ss << kTableTypedefs;
+
+    // 翻译表与规则表不计入分析表大小的统计
+    std::size_t auxBytes = 0;
+    if (tables.sparse_translate.empty()) {
+        emitTableArray(ss, "yytranslate_table", tables.translate, auxBytes, output_threads.get(), 0, definitions);
+
+        ss << "static inline int yytranslate_token(int token) {\n";
+        ss << "  if (token < 0 || token > YYMAXUTOK) {\n";
+        ss << "    return YYUNDEF;\n";
+        ss << "  }\n";
+        ss << "  return yytranslate_table[token];\n";
+        ss << "}\n\n";
+        *out_stream << "词法值翻译表: 直接数组 " << tables.translate.size() << " 项, " << auxBytes << " 字节" << std::endl;
+    } else {
+        // 多字符字面量使编码稀疏，改用完美哈希: 一次取模、一次比较，没有难以预测的分支
+        const TranslateHash hash = buildTranslateHash(tables.sparse_translate);
+        ss << "#define YYTRANSLATE_MOD " << hash.modulus << "\n\n";
+        ss << "/* 词法值的完美哈希: 槽位为 词法值 % YYTRANSLATE_MOD，空槽的键为 -1 */\n";
+        emitTableArray(ss, "yytranslate_hkey", hash.keys, auxBytes, output_threads.get(), 0, definitions);
+        emitTableArray(ss, "yytranslate_hval", hash.values, auxBytes, output_threads.get(), 0, definitions);
+
+        ss << "static inline int yytranslate_token(int token) {\n";
+        ss << "  if (token < 0 || token > YYMAXUTOK) {\n";
+        ss << "    return YYUNDEF;\n";
+        ss << "  }\n";
+        ss << "  int slot = token % YYTRANSLATE_MOD;\n";
+        ss << "  return yytranslate_hkey[slot] == token ? yytranslate_hval[slot] : YYUNDEF;\n";
+        ss << "}\n\n";
+        *out_stream << "词法值翻译表: 完美哈希 " << hash.modulus << " 槽, " << auxBytes
+                    << " 字节（直接数组需要 " << tables.max_user_token + 1 << " 项）" << std::endl;
     }
-    ss << "};\n\n";
 
     // 添加 token 名称表
     ss << "/* Token 名称表 */\n";
     ss << "static const char* yytname[] = {\n";
     ss << "  \"$end\"";
-    for (const auto& terminal : terminals) {
-        ss << ",\n  \"" << terminal.name << "\"";
+    for (const std::string& name : tables.token_names) {
+        ss << ",\n  \"" << name << "\"";
     }
     ss << "\n};\n\n";
 
-    // 生成GOTO表
-    ss << "static const short yygoto[] = {\n";
-
-    for (int state = 0; state < canonical_collection.size(); ++state) {
-        ss << "  /* 状态 " << state << " */\n  ";
-        for (const auto& nonTerminal : nonTerminals) {
-            if (goto_table.find(state) != goto_table.end() && goto_table.at(state).find(nonTerminal) != goto_table.at(state).end()) {
-
-                int nextState = goto_table.at(state).at(nonTerminal);
-                ss << nextState << ", ";
-            } else {
-                // 无效状态
-                ss << "-1, ";
-            }
-        }
-        ss << "\n";
-    }
-    ss << "};\n\n";
+    // 添加动作和状态转移表
+    emitParseTables(ss, tables, definitions);
 
     // 产生式左部的非终结符索引表
     ss << "/* 每条产生式左部的非终结符索引 */\n";
-    ss << "static const short yyr1[] = {\n  ";
-
-    // 计算非终结符的索引（从YYNTOKENS开始）
-    std::unordered_map<std::string, int> nonterm_index;
-    int idx = terminals.size(); // 非终结符索引从终结符数量开始
-    for (const auto& nt : nonTerminals) {
-        nonterm_index[nt.name] = idx++;
-    }
-
-    // 生成yyr1数组
-    for (const auto& prod : parser.productions) {
-        if (nonterm_index.find(prod.left.name) != nonterm_index.end()) {
-            ss << nonterm_index[prod.left.name] << ", ";
-        } else {
-            ss << "0, "; // 默认值，理论上不会出现
-        }
-    }
-
-    ss << "\n};\n\n";
+    emitTableArray(ss, "yyr1", tables.rule_lhs, auxBytes, output_threads.get(), 0, definitions);
 
     // 产生式长度表
     ss << "/* 每条产生式右部的符号数量 */\n";
-    ss << "static const short yyr2[] = {\n  ";
-
-    for (const auto& prod : parser.productions) {
-        ss << prod.right.size() << ", ";
-    }
-
-    ss << "\n};\n\n";
+    emitTableArray(ss, "yyr2", tables.rule_length, auxBytes, output_threads.get(), 0, definitions);
+
+    // 状态剖析: 统计每个状态的访问次数，供 --state-profile 重新编号状态
+    ss << "#ifdef YYPROFILE\n";
+    ss << "/* 以 -DYYPROFILE='\"文件名\"' 编译时统计每个状态的访问次数，程序退出时累加写入该文件 */\n";
+    if (tables.state_origin.empty()) {
+        ss << "#define YYSTATE_ORIGIN(state) (state)\n";
+        ss << "#define YYNORIGINS YYNSTATES\n\n";
+    } else {
+        // 剖析文件按自动机中的原编号记录，与状态的输出顺序无关；
+        // 消除单元规约会删除状态，原编号可能不小于 YYNSTATES
+        std::size_t originBytes = 0;
+        ss << "/* 每个状态在自动机中的原编号 */\n";
+        emitTableArray(ss, "yystate_origin", tables.state_origin, originBytes, output_threads.get());
+        ss << "#define YYSTATE_ORIGIN(state) yystate_origin[state]\n";
+        ss << "#define YYNORIGINS " << (*std::max_element(tables.state_origin.begin(), tables.state_origin.end()) + 1)
+           << "\n\n";
+    }
+    ss << "static unsigned long long yyprofile_counts[YYNORIGINS];\n\n";
+    ss << "static void yyprofile_write(void) {\n";
+    ss << "  char line[128];\n";
+    ss << "  long long state;\n";
+    ss << "  unsigned long long count;\n";
+    ss << "  FILE* file = fopen(YYPROFILE, \"r\");\n";
+    ss << "  if (file) {\n";
+    ss << "    while (fgets(line, sizeof(line), file)) {\n";
+    ss << "      if (line[0] != '#' && sscanf(line, \"%lld %llu\", &state, &count) == 2 && state >= 0 && state < YYNORIGINS) {\n";
+    ss << "        yyprofile_counts[state] += count;\n";
+    ss << "      }\n";
+    ss << "    }\n";
+    ss << "    fclose(file);\n";
+    ss << "  }\n";
+    ss << "  file = fopen(YYPROFILE, \"w\");\n";
+    ss << "  if (!file) {\n";
+    ss << "    return;\n";
+    ss << "  }\n";
+    ss << "  fprintf(file, \"# seuyacc state profile: state count\\n\");\n";
+    ss << "  for (int i = 0; i < YYNORIGINS; i++) {\n";
+    ss << "    if (yyprofile_counts[i] != 0) {\n";
+    ss << "      fprintf(file, \"%d %llu\\n\", i, yyprofile_counts[i]);\n";
+    ss << "    }\n";
+    ss << "  }\n";
+    ss << "  fclose(file);\n";
+    ss << "}\n\n";
+    ss << "static void yyprofile_count(int state) {\n";
+    ss << "  static int registered = 0;\n";
+    ss << "  if (!registered) {\n";
+    ss << "    registered = 1;\n";
+    ss << "    atexit(yyprofile_write);\n";
+    ss << "  }\n";
+    ss << "  yyprofile_counts[YYSTATE_ORIGIN(state)]++;\n";
+    ss << "}\n";
+    ss << "#endif\n\n";
 
-    // 生成规约动作代码
-    ss << "/* 执行规约动作 */\n";
-    ss << "static void yy_reduce(int rule_num, int* top, YYSTYPE* stack, int* state_stack) {\n";
-    ss << "  int symbols_to_pop = yyr2[rule_num];\n";
-    ss << "  printf(\"  规约详情: 规则%d, 当前栈顶=%d, 弹出%d个符号\\n\", rule_num, *top, symbols_to_pop);\n";
-    ss << "  YYSTYPE yyval;\n\n";
-
-    ss << "  /* 计算栈中元素的位置, $1 是栈中第一个要规约的元素 */\n";
-    ss << "  /* 对应关系: $1 = yyvsp[1], $2 = yyvsp[2], 以此类推 */\n";
-    ss << "  YYSTYPE yyvsp[YYMAXDEPTH + 1]; // 临时数组，下标从1开始\n";
-    ss << "  for (int i = 1; i <= symbols_to_pop; i++) {\n";
-    ss << "    yyvsp[i] = stack[*top - symbols_to_pop + i];\n";
-    ss << "  }\n\n";
+    // 分析栈: 状态与语义值按层相邻存放
+    ss << "/* 分析栈的一层: 状态与对应符号的语义值相邻存放 */\n";
+    ss << "typedef struct yystack_entry {\n";
+    ss << "  int state;\n";
+    ss << "  YYSTYPE value;\n";
+    ss << "} yystack_entry;\n\n";
+
+    // 栈扩容: 只在栈满时调用，不在常规的移入/规约路径上
+    ss << "/* 分析栈已满时扩大一倍（不超过 YYMAXDEPTH），成功返回 0，已达上限或分配失败返回 -1 */\n";
+    ss << "static int yygrowstack(yystack_entry** yystack, yystack_entry** yysp, int* yystacksize, yystack_entry* yystackinit) {\n";
+    ss << "  int yynewsize;\n";
+    ss << "  yystack_entry* yynewstack;\n";
+    ss << "  if (*yystacksize >= YYMAXDEPTH) {\n";
+    ss << "    return -1;\n";
+    ss << "  }\n";
+    ss << "  yynewsize = *yystacksize > YYMAXDEPTH / 2 ? YYMAXDEPTH : *yystacksize * 2;\n";
+    ss << "  if (*yystack == yystackinit) {\n";
+    ss << "    yynewstack = (yystack_entry*) YYMALLOC((size_t) yynewsize * sizeof(yystack_entry));\n";
+    ss << "    if (yynewstack) {\n";
+    ss << "      memcpy(yynewstack, yystackinit, (size_t) *yystacksize * sizeof(yystack_entry));\n";
+    ss << "    }\n";
+    ss << "  } else {\n";
+    ss << "    yynewstack = (yystack_entry*) YYREALLOC(*yystack, (size_t) yynewsize * sizeof(yystack_entry));\n";
+    ss << "  }\n";
+    ss << "  if (!yynewstack) {\n";
+    ss << "    return -1;\n";
+    ss << "  }\n";
+    ss << "  YYDPRINTF(1, (stderr, \"分析栈扩大到 %d 层\\n\", yynewsize));\n";
+    ss << "  *yysp = yynewstack + (*yysp - *yystack);\n";
+    ss << "  *yystack = yynewstack;\n";
+    ss << "  *yystacksize = yynewsize;\n";
+    ss << "  return 0;\n";
+    ss << "}\n\n";
 
-    ss << "  /* 默认动作: 将$1的值赋给$$ */\n";
-    ss << "  if (symbols_to_pop > 0) {\n";
-    ss << "    yyval = yyvsp[1]; // $$ = $1\n";
-    ss << "  }\n\n";
+    // 主解析函数: 拉取式的 yyparse 自己调用 yylex，推送式的 yypush_parse 每次接收一个 token
+    if (!g.pushParser()) {
+        writeParseFunction(ss, tables, false);
+    } else {
+        ss << "/* 推送式解析器的状态: 两次调用之间保存的状态与分析栈 */\n";
+        ss << "struct yypstate {\n";
+        ss << "  yyparse_ctx* ctx;\n";
+        ss << "  int state;\n";
+        ss << "  yystack_entry* stack;\n";
+        ss << "  yystack_entry* sp;\n";
+        ss << "  int stacksize;\n";
+        ss << "  yystack_entry stackinit[YYINITDEPTH];\n";
+        ss << "};\n\n";
+        ss << "static void yypstate_init(yypstate* yyps, yyparse_ctx* yyctx) {\n";
+        ss << "  YYDPRINTF(1, (stderr, \"====== 开始语法分析 ======\\n\"));\n";
+        ss << "  yyps->ctx = yyctx;\n";
+        ss << "  yyps->state = 0;\n";
+        ss << "  yyps->stack = yyps->stackinit;\n";
+        ss << "  yyps->sp = yyps->stack;\n";
+        ss << "  yyps->stacksize = YYINITDEPTH;\n";
+        ss << "  yyps->sp->state = 0;\n";
+        ss << "}\n\n";
+        ss << "yypstate* yypstate_new(yyparse_ctx* ctx) {\n";
+        ss << "  yypstate* yyps = (yypstate*) YYMALLOC(sizeof(yypstate));\n";
+        ss << "  if (yyps) {\n";
+        ss << "    yypstate_init(yyps, ctx);\n";
+        ss << "  }\n";
+        ss << "  return yyps;\n";
+        ss << "}\n\n";
+        ss << "void yypstate_delete(yypstate* ps) {\n";
+        ss << "  if (!ps) {\n";
+        ss << "    return;\n";
+        ss << "  }\n";
+        ss << "  if (ps->stack != ps->stackinit) {\n";
+        ss << "    YYFREE(ps->stack);\n";
+        ss << "  }\n";
+        ss << "  YYFREE(ps);\n";
+        ss << "}\n\n";
+
+        writeParseFunction(ss, tables, true);
+
+        if (g.pullParser()) {
+            // 拉取式接口建立在推送式接口之上，语义动作只生成一份
+            ss << "/* 拉取式接口: 反复调用 yylex 并把 token 推送给 yypush_parse */\n";
+            ss << "int yyparse(yyparse_ctx* yyctx) {\n";
+            ss << "  yypstate yyps;\n";
+            ss << "  YYSTYPE yylval;\n";
+            ss << "  int yystatus;\n";
+            ss << "  yypstate_init(&yyps, yyctx);\n";
+            ss << "  do {\n";
+            ss << "    int yytoken_raw = yylex(&yylval, yyctx);\n";
+            ss << "    yystatus = yypush_parse(&yyps, yytoken_raw, &yylval);\n";
+            ss << "  } while (yystatus == YYPUSH_MORE);\n";
+            ss << "  return yystatus;\n";
+            ss << "}\n\n";
+        }
+    }
 
-    ss << "  /* 根据规则执行语义动作 */\n";
-    ss << "  printf(\"  执行语义动作: 规则%d\\n\", rule_num);\n";
-    ss << "  switch(rule_num) {\n";
+    // 添加用户代码
+    if (!g.programCode().empty()) {
+        ss << "/* 用户代码 */\n";
+        ss << g.programCode() << "\n";
+    }
 
-    // 生成每条规则的语义动作
-    for (size_t i = 0; i < parser.productions.size(); ++i) {
-        const Production& prod = parser.productions[i];
+}
 
-        ss << "    case " << i << ": /* " << prod.left.name << " -> ";
-        if (prod.right.empty()) {
-            ss << "ε";
+void LRGenerator::writeParseFunction(std::ostream& ss, const ParseTables& tables, bool push) const
+{
+    const Grammar& g = *grammar;
+    const bool pure = g.pureParser();
+    const std::string errs = pure ? "yyctx->" : "";
+    const std::string yyerrorCall = pure ? "yyerror(yyctx, " : "yyerror(";
+
+    if (push) {
+        ss << "/* 推送式语法分析: 每次调用接收一个 token，需要下一个 token 时保存状态并返回 YYPUSH_MORE */\n";
+        ss << "int yypush_parse(yypstate* yyps, int yypushed_token, const YYSTYPE* yypushed_value) {\n";
+        ss << "  yyparse_ctx* yyctx = yyps->ctx;\n";
+        ss << "  YYSTYPE yylval;\n";
+        ss << "  int yystate = yyps->state;\n";
+        ss << "  int yytoken_raw = yypushed_token;\n";
+        ss << "  int yytoken;\n";
+    } else {
+        ss << "/* 语法分析主函数 */\n";
+        if (pure) {
+            ss << "int yyparse(yyparse_ctx* yyctx) {\n";
+            ss << "  YYSTYPE yylval; /* yylex 通过指针写入向前看符号的语义值 */\n";
         } else {
-            for (const Symbol& sym : prod.right) {
-                ss << sym.name << " ";
-            }
-        }
-
-        ss << " */\n";
-
-        // 如果有语义动作，处理并添加它
-        if (!prod.semantic_action.empty()) {
-            std::string processed_action = processSemanticAction(
-                prod.semantic_action.substr(1, prod.semantic_action.length() - 2), // 去除大括号
-                prod);
-            ss << "      {\n"; // 添加开始花括号
-            ss << "        " << processed_action << "\n";
-            ss << "        printf(\"    完成语义动作: %s\\n\", \"" << prod.left.name << "\");\n";
-            ss << "      }\n"; // 添加结束花括号
+            ss << "int yyparse(void) {\n";
         }
+        ss << "  int yystate = 0;\n";
+        ss << "  int yytoken_raw = 0;\n";
+        ss << "  int yytoken = YYEMPTY; /* 向前看符号在需要时才读入 */\n";
+    }
+    ss << "  int yyn;     /* 当前动作 */\n";
+    ss << "  int yyrule;  /* 规约使用的规则 */\n";
+    ss << "  int yylen;   /* 规约弹出的符号数 */\n";
+    ss << "  YYSTYPE yyval;\n";
+    ss << "  int yyresult;\n";
+    if (push) {
+        // 分析栈保存在 yyps 中，两次调用之间保持不变
+        ss << "  yystack_entry* yystackinit = yyps->stackinit;\n";
+        ss << "  yystack_entry* yystack = yyps->stack;\n";
+        ss << "  yystack_entry* yysp = yyps->sp; /* 栈顶，规约时 $N 即 yysp[N - yylen].value */\n";
+        ss << "  int yystacksize = yyps->stacksize;\n\n";
+
+        ss << "  if (yypushed_value) {\n";
+        ss << "    yylval = *yypushed_value;\n";
+        ss << "  } else {\n";
+        ss << "    memset(&yylval, 0, sizeof(yylval));\n";
+        ss << "  }\n";
+        ss << "  yytoken = yytranslate_token(yytoken_raw);\n";
+        ss << "  YYDPRINTF(1, (stderr, \"获取下一个token: raw=%d, translated=%d\\n\", yytoken_raw, yytoken));\n";
+        ss << "  YYTRACE(YYTRACE_TOKEN, yystate, yytoken);\n\n";
+    } else {
+        ss << "  yystack_entry yystackinit[YYINITDEPTH];\n";
+        ss << "  yystack_entry* yystack = yystackinit;\n";
+        ss << "  yystack_entry* yysp = yystack; /* 栈顶，规约时 $N 即 yysp[N - yylen].value */\n";
+        ss << "  int yystacksize = YYINITDEPTH;\n\n";
 
-        ss << "      break;\n";
+        ss << "  YYDPRINTF(1, (stderr, \"====== 开始语法分析 ======\\n\"));\n";
+        ss << "  yysp->state = 0;\n\n";
     }
 
-    ss << "  }\n\n";
-    ss << "  /* 保存归约结果，主函数负责调整栈 */\n";
-    ss << "  stack[*top - symbols_to_pop + 1] = yyval;\n";
-    ss << "}\n\n";
-
-    // 主解析函数
-    ss << "/* 语法分析主函数 */\n";
-    ss << "int yyparse(void) {\n";
-    ss << "  int state = 0;\n";
-    ss << "  int top = 0;\n";
-    ss << "  int token_raw;\n";
-    ss << "  int token;\n";
-    ss << "  int action;\n";
-    ss << "  YYSTYPE stack[YYMAXDEPTH];\n";
-    ss << "  int state_stack[YYMAXDEPTH];\n\n"; // 添加状态栈
-
-    ss << "  printf(\"====== 开始语法分析 ======\\n\");\n";
-    ss << "  state_stack[0] = 0;\n";
-    ss << "  token_raw = yylex();\n";
-    ss << "  token = yytranslate_token(token_raw);\n";
-    ss << "  printf(\"获取首个token: raw=%d, translated=%d\\n\", token_raw, token);\n\n";
-
     ss << "  while (1) {\n";
-    ss << "    printf(\"当前状态: %d, token(raw)=%d, token(translated)=%d\\n\", state, token_raw, token);\n";
-    ss << "    if (token == YYUNDEF) {\n";
-    ss << "      printf(\"检测到未定义的token: %d\\n\", token_raw);\n";
-    ss << "      yyerror(\"无法识别的终结符\");\n";
-    ss << "      return 1;\n";
+    ss << "    /* 每一步至多使栈净增一层，在这里保证还有空位 */\n";
+    ss << "    if (yysp + 1 >= yystack + yystacksize && yygrowstack(&yystack, &yysp, &yystacksize, yystackinit) != 0) {\n";
+    ss << "      YYDPRINTF(1, (stderr, \"分析栈溢出: 深度 %d, 上限 %d\\n\", yystacksize, YYMAXDEPTH));\n";
+    ss << "      YYTRACE(YYTRACE_ERROR, yystate, yystacksize);\n";
+    ss << "      " << yyerrorCall << "\"分析栈溢出\");\n";
+    ss << "      yyresult = 2;\n";
+    ss << "      goto yyreturn;\n";
+    ss << "    }\n";
+    ss << "#ifdef YYPROFILE\n";
+    ss << "    yyprofile_count(yystate);\n";
+    ss << "#endif\n";
+    ss << "    if (yy_default_only(yystate)) {\n";
+    ss << "      /* 只有默认规约的状态不查看向前看符号 */\n";
+    ss << "      YYDPRINTF(2, (stderr, \"当前状态: %d, 执行默认规约\\n\", yystate));\n";
+    ss << "      yyn = -yydefact[yystate];\n";
+    ss << "    } else {\n";
+    ss << "      if (yytoken == YYEMPTY) {\n";
+    if (push) {
+        ss << "        /* 等待下一个 token */\n";
+        ss << "        yyps->state = yystate;\n";
+        ss << "        yyps->stack = yystack;\n";
+        ss << "        yyps->sp = yysp;\n";
+        ss << "        yyps->stacksize = yystacksize;\n";
+        ss << "        return YYPUSH_MORE;\n";
+    } else {
+        ss << "        yytoken_raw = " << (pure ? "yylex(&yylval, yyctx)" : "yylex()") << ";\n";
+        ss << "        yytoken = yytranslate_token(yytoken_raw);\n";
+        ss << "        YYDPRINTF(1, (stderr, \"获取下一个token: raw=%d, translated=%d\\n\", yytoken_raw, yytoken));\n";
+        ss << "        YYTRACE(YYTRACE_TOKEN, yystate, yytoken);\n";
+    }
+    ss << "      }\n";
+    ss << "      YYDPRINTF(2, (stderr, \"当前状态: %d, token(raw)=%d, token(translated)=%d\\n\", yystate, yytoken_raw, yytoken));\n";
+    ss << "      if (yytoken == YYUNDEF) {\n";
+    ss << "        YYDPRINTF(1, (stderr, \"检测到未定义的token: %d\\n\", yytoken_raw));\n";
+    ss << "        YYTRACE(YYTRACE_ERROR, yystate, yytoken_raw);\n";
+    ss << "        " << yyerrorCall << "\"无法识别的终结符\");\n";
+    ss << "        yyresult = 1;\n";
+    ss << "        goto yyreturn;\n";
+    ss << "      }\n\n";
+
+    ss << "      yyn = yy_action(yystate, yytoken);\n";
+    ss << "      YYDPRINTF(2, (stderr, \"查找动作: 状态%d, token %d -> %d (raw token %d)\\n\", yystate, yytoken, yyn, yytoken_raw));\n";
+    ss << "      if (yyn == YYERRACT && yydefact[yystate] != 0) {\n";
+    ss << "        yyn = -yydefact[yystate]; /* 默认规约 */\n";
+    ss << "      }\n";
     ss << "    }\n\n";
 
-    ss << "    action = yytable[state * YYNTOKENS + token];\n\n";
-    ss << "    printf(\"查找动作: yytable[%d * %d + %d] = %d (raw token %d)\\n\", state, YYNTOKENS, token, action, token_raw);\n\n";
-
-    ss << "    if (action == -32767) { /* 错误 */\n";
+    ss << "    if (yyn == YYERRACT) { /* 错误 */\n";
+    ss << "      YYDPRINTF(1, (stderr, \"语法错误: 状态%d, token %d\\n\", yystate, yytoken));\n";
+    ss << "      YYTRACE(YYTRACE_ERROR, yystate, yytoken);\n";
     ss << "      /* 收集期待的 token */\n";
     ss << "      const char* expected[YYNTOKENS];\n";
     ss << "      int expected_count = 0;\n";
     ss << "      for (int i = 0; i < YYNTOKENS; i++) {\n";
-    ss << "        int test_action = yytable[state * YYNTOKENS + i];\n";
-    ss << "        if (test_action != -32767) {\n";
+    ss << "        int test_action = yy_action(yystate, i);\n";
+    ss << "        if (test_action != YYERRACT) {\n";
     ss << "          expected[expected_count++] = yytname[i];\n";
     ss << "        }\n";
     ss << "      }\n";
     ss << "      \n";
     ss << "      /* 记录错误 */\n";
-    ss << "      extern int yylineno;\n";
-    ss << "      extern char* yytext;\n";
-    ss << "      add_error(yylineno, \"syntax error, unexpected token\", yytext, expected, expected_count);\n";
-    ss << "      \n";
-    ss << "      /* 输出错误并退出 */\n";
-    ss << "      print_errors_json();\n";
-    ss << "      return 1;\n";
+    if (pure) {
+        ss << "      add_error(yyctx, yyctx->lineno, \"syntax error, unexpected token\", yyctx->text, expected, expected_count);\n";
+    } else {
+        ss << "      extern int yylineno;\n";
+        ss << "      extern char* yytext;\n";
+        ss << "      add_error(yylineno, \"syntax error, unexpected token\", yytext, expected, expected_count);\n";
+        ss << "      \n";
+        ss << "      /* 输出错误并退出 */\n";
+        ss << "      print_errors_json(stdout);\n";
+    }
+    ss << "      yyresult = 1;\n";
+    ss << "      goto yyreturn;\n";
     ss << "    }\n\n";
 
-    ss << "    if (action > 0) { /* 移入 */\n";
-    ss << "      printf(\"执行移入操作: 状态%d -> 状态%d\\n\", state, action);\n";
-    ss << "      stack[++top] = yylval;\n";
-    ss << "      state_stack[top] = action;\n"; // 存储新状态
-    ss << "      state = action;\n";
-    ss << "      int next_raw = yylex();\n";
-    ss << "      int next_token = yytranslate_token(next_raw);\n";
-    ss << "      printf(\"获取下一个token: raw=%d\\n\", next_raw);\n";
-    ss << "      printf(\"转换token结果: %d -> %d\\n\", next_raw, next_token);\n";
-    ss << "      token_raw = next_raw;\n";
-    ss << "      token = next_token;\n";
-    ss << "    } else if (action < 0) { /* 规约 */\n";
-    ss << "      int rule = -action - 1;\n";
-    ss << "      printf(\"执行规约操作: 使用规则%d\\n\", rule);\n";
-    ss << "      yy_reduce(rule, &top, stack, state_stack);\n";
-    ss << "      printf(\"规约后的栈顶位置: %d\\n\", top);\n";
-
-    ss << "      /* 弹出状态栈中的规约符号对应的状态 */\n";
-    ss << "      int symbols_to_pop = yyr2[rule];\n";
-    ss << "      top -= symbols_to_pop;\n"; // 先调整栈顶指针
-    ss << "      printf(\"规约后的状态栈顶: %d, 当前状态: %d\\n\", top, state_stack[top]);\n";
-
-    ss << "      /* 通过GOTO表确定新状态 */\n";
-    ss << "      int nonterminal = yyr1[rule] - YYNTOKENS;\n";
-    ss << "      int goto_index = state_stack[top] * YYNNTS + nonterminal;\n";
-    ss << "      printf(\"GOTO表查询: 状态%d + 非终结符%d, 索引=%d\\n\", state_stack[top], nonterminal, goto_index);\n";
+    if (tables.shift_reduce) {
+        ss << "    if (yyn >= YYNSTATES) { /* 移入后立即规约，不进入只有一个规约的目标状态 */\n";
+        ss << "      YYDPRINTF(1, (stderr, \"执行移入-规约操作: 状态%d, 规则%d\\n\", yystate, yyn - YYNSTATES));\n";
+        ss << "      YYTRACE(YYTRACE_SHIFT, yystate, yyn);\n";
+        ss << "      ++yysp;\n";
+        ss << "      yysp->state = yystate;\n"; // 占位，规约时立即弹出
+        ss << "      yysp->value = yylval;\n";
+        ss << "      yytoken = YYEMPTY;\n";
+        ss << "      yyn = YYNSTATES - 1 - yyn;\n"; // 转为规约编码 -(rule+1)
+        ss << "    }\n\n";
+    }
+
+    ss << "    if (yyn > 0) { /* 移入 */\n";
+    ss << "      YYDPRINTF(1, (stderr, \"执行移入操作: 状态%d -> 状态%d\\n\", yystate, yyn));\n";
+    ss << "      YYTRACE(YYTRACE_SHIFT, yystate, yyn);\n";
+    ss << "      ++yysp;\n";
+    ss << "      yysp->state = yyn;\n";
+    ss << "      yysp->value = yylval;\n";
+    ss << "      yystate = yyn;\n";
+    ss << "      yytoken = YYEMPTY;\n";
+    ss << "    } else if (yyn < 0) { /* 规约 */\n";
+    ss << "      yyrule = -yyn - 1;\n";
+    if (tables.shift_reduce) {
+        ss << "    yyreduce:\n";
+    }
+    ss << "      yylen = yyr2[yyrule];\n";
+    ss << "      YYDPRINTF(1, (stderr, \"执行规约操作: 使用规则%d\\n\", yyrule));\n";
+    ss << "      YYTRACE(YYTRACE_REDUCE, yysp->state, yyrule);\n";
+    ss << "      YYDPRINTF(2, (stderr, \"  规约详情: 规则%d, 当前栈顶=%d, 弹出%d个符号\\n\", yyrule, (int) (yysp - yystack), yylen));\n\n";
+
+    ss << "      /* 语义动作直接读写栈中的值，默认动作为 $$ = $1；\n";
+    ss << "         空规则读到的是栈顶之上的空位（循环开头已保证存在），其值未定义 */\n";
+    ss << "      yyval = yysp[1 - yylen].value;\n";
+    ss << "      switch (yyrule) {\n";
+
+    // 生成每条规则的语义动作，没有动作的规则由 default 处理
+    for (ProductionId i = 0; i < g.productionCount(); ++i) {
+        const std::string& action = g.semanticAction(i);
+        if (action.empty()) {
+            continue;
+        }
+        ss << "      case " << i << ": /* " << g.name(g.left(i)) << " -> ";
+        if (g.right(i).empty()) {
+            ss << "ε";
+        } else {
+            for (SymbolId sym : g.right(i)) {
+                ss << g.name(sym) << " ";
+            }
+        }
+        ss << " */\n";
+
+        std::string processed_action = processSemanticAction(
+            action.substr(1, action.length() - 2), // 去除大括号
+            i);
+        ss << "        {\n";
+        ss << "          " << processed_action << "\n";
+        ss << "          YYDPRINTF(2, (stderr, \"    完成语义动作: %s\\n\", \"" << g.name(g.left(i)) << "\"));\n";
+        ss << "        }\n";
+        ss << "        break;\n";
+    }
+    ss << "      default:\n";
+    ss << "        break;\n";
+    ss << "      }\n\n";
+
+    ss << "      /* 弹出规约的符号，通过GOTO表确定新状态 */\n";
+    ss << "      yysp -= yylen;\n";
+    ss << "      YYDPRINTF(2, (stderr, \"规约后的状态栈顶: %d, 当前状态: %d\\n\", (int) (yysp - yystack), yysp->state));\n";
+    ss << "      int nonterminal = yyr1[yyrule] - YYNTOKENS;\n";
+    ss << "      YYDPRINTF(2, (stderr, \"GOTO表查询: 状态%d + 非终结符%d\\n\", yysp->state, nonterminal));\n";
 
     // 添加安全检查
-    ss << "      if (goto_index < 0 || goto_index >= " << (canonical_collection.size() * nonTerminals.size()) << ") {\n";
-    ss << "        printf(\"错误: GOTO表索引越界! goto_index=%d\\n\", goto_index);\n";
-    ss << "        yyerror(\"GOTO表索引错误\");\n";
-    ss << "        return 3;\n";
+    ss << "      if (nonterminal < 0 || nonterminal >= YYNNTS) {\n";
+    ss << "        YYDPRINTF(1, (stderr, \"错误: GOTO表索引越界! nonterminal=%d\\n\", nonterminal));\n";
+    ss << "        " << yyerrorCall << "\"GOTO表索引错误\");\n";
+    ss << "        yyresult = 3;\n";
+    ss << "        goto yyreturn;\n";
     ss << "      }\n";
 
-    ss << "      int next_state = yygoto[goto_index];\n";
-    ss << "      printf(\"GOTO表结果: [%d][%d] = %d\\n\", state_stack[top], nonterminal, next_state);\n";
+    ss << "      int next_state = yy_goto(yysp->state, nonterminal);\n";
+    ss << "      YYDPRINTF(2, (stderr, \"GOTO表结果: [%d][%d] = %d\\n\", yysp->state, nonterminal, next_state));\n";
 
     ss << "      if (next_state == -1) {\n";
-    ss << "        printf(\"错误: GOTO表中没有对应项! 状态%d, 非终结符%d\\n\", state_stack[top], nonterminal);\n";
-    ss << "        yyerror(\"GOTO表错误\");\n";
-    ss << "        return 2;\n";
+    ss << "        YYDPRINTF(1, (stderr, \"错误: GOTO表中没有对应项! 状态%d, 非终结符%d\\n\", yysp->state, nonterminal));\n";
+    ss << "        " << yyerrorCall << "\"GOTO表错误\");\n";
+    ss << "        yyresult = 2;\n";
+    ss << "        goto yyreturn;\n";
     ss << "      }\n";
-
-    ss << "      /* 将新状态压入栈 */\n";
-    ss << "      state_stack[++top] = next_state;\n"; // 压入新状态
-    ss << "      state = next_state;\n";
-    ss << "      printf(\"规约后的新状态: %d\\n\", state);\n";
+    ss << "      ++yysp;\n";
+    ss << "      yysp->value = yyval;\n";
+
+    if (tables.shift_reduce) {
+        ss << "      if (next_state >= YYNSTATES) { /* GOTO 的目标状态只有一个规约，直接继续规约 */\n";
+        ss << "        yysp->state = yysp[-1].state;\n"; // 占位，规约时立即弹出
+        ss << "        yyrule = next_state - YYNSTATES;\n";
+        ss << "        goto yyreduce;\n";
+        ss << "      }\n";
+    }
+    ss << "      yysp->state = next_state;\n";
+    ss << "      yystate = next_state;\n";
+    ss << "      YYDPRINTF(1, (stderr, \"规约后的新状态: %d\\n\", yystate));\n";
+    ss << "      YYTRACE(YYTRACE_GOTO, yysp[-1].state, yystate);\n";
     ss << "    } else { /* 接受 */\n";
-    ss << "      printf(\"接受输入, 分析成功完成!\\n\");\n";
-    ss << "      if (error_count > 0) {\n";
-    ss << "        print_errors_json();\n";
-    ss << "        return 1;\n";
+    ss << "      YYDPRINTF(1, (stderr, \"接受输入, 分析成功完成!\\n\"));\n";
+    ss << "      YYTRACE(YYTRACE_ACCEPT, yystate, 0);\n";
+    ss << "      yyresult = 0;\n";
+    ss << "      if (" << errs << "error_count > 0) {\n";
+    if (!pure) {
+        ss << "        print_errors_json(stdout);\n";
+    }
+    ss << "        yyresult = 1;\n";
     ss << "      }\n";
-    ss << "      return 0;\n";
+    ss << "      goto yyreturn;\n";
     ss << "    }\n";
-    ss << "    printf(\"--------------------\\n\");\n"; // 分隔不同的状态转换
-    ss << "  }\n";
-    ss << "  printf(\"====== 语法分析结束 ======\\n\");\n";
-    ss << "  \n";
-    ss << "  /* 如果有错误，输出 JSON */\n";
-    ss << "  if (error_count > 0) {\n";
-    ss << "    print_errors_json();\n";
-    ss << "    return 1;\n";
+    ss << "    YYDPRINTF(2, (stderr, \"--------------------\\n\"));\n"; // 分隔不同的状态转换
+    ss << "  }\n\n";
+    ss << "yyreturn:\n";
+    ss << "  if (yystack != yystackinit) {\n";
+    ss << "    YYFREE(yystack);\n";
     ss << "  }\n";
-    ss << "  return 0;\n";
+    if (push) {
+        ss << "  yypstate_init(yyps, yyctx); /* 解析结束，下一个 token 开始新的解析 */\n";
+    }
+    ss << "  return yyresult;\n";
     ss << "}\n\n";
 
-    // 添加用户代码
-    if (!parser.program_code.empty()) {
-        ss << "/* 用户代码 */\n";
-        ss << parser.program_code << "\n";
-    }
+}
 
+std::string LRGenerator::toPlantUML(const ExportFilter& filter) const
+{
+    std::ostringstream ss;
+    writePlantUML(ss, filter);
     return ss.str();
 }
 
-void LRGenerator::buildCanonicalCollection()
+void LRGenerator::writePlantUML(std::ostream& out, const ExportFilter& filter) const
 {
-    transitions.clear();
-    canonical_collection.clear();
-
-    // 首先添加增广文法的起始项
-    addAugmentedProduction();
-
-    if (parser.productions.empty()) {
-        std::cerr << "错误: 产生式列表为空!" << std::endl;
-        return;
-    }
-
-    // 创建初始项集
-    ItemSet initialItemSet;
-    LRItem initialItem = {
-        parser.productions[0],
-        0,
-        parser.getSymbol("$")
-    };
-    initialItemSet.items.push_back(initialItem);
-    initialItemSet.state_id = 0;
-
-    ItemSet closure0 = computeClosure(initialItemSet);
-
-    canonical_collection.push_back(closure0);
-
-    // 使用工作表算法构建项集规范族
-    std::vector<ItemSet> worklist = { closure0 };
-
-    while (!worklist.empty()) {
-        ItemSet current = worklist.back();
-        worklist.pop_back();
-
-        // 收集当前项集中点号后的所有符号
-        std::unordered_set<Symbol, SymbolHasher> symbols;
-        for (const LRItem& item : current.items) {
-            if (item.dot_position < item.prod.right.size()) {
-                symbols.insert(item.prod.right[item.dot_position]);
+    const Grammar& g = *grammar;
+    const std::vector<int> states = exportStates(filter);
+    std::vector<bool> selected(canonical_collection.size(), false);
+    for (int state : states) {
+        selected[state] = true;
+    }
+
+    out << "@startuml\n";
+    if (selected[0]) {
+        out << "[*] --> State0\n";
+    }
+
+    // 添加选中状态的项集内容，按状态分块并行格式化
+    writeChunked(out, states.size(), kStateChunk, [this, &g, &states](std::ostream& ss, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const ItemSet& itemSet = canonical_collection[states[i]];
+            ss << "State" << itemSet.state_id << " : ";
+
+            // 项按 (产生式, 点号, 向前看符号) 排序，核心相同的项相邻，合并输出它们的向前看符号
+            const std::vector<LRItem>& items = itemSet.items;
+            for (std::size_t k = 0; k < items.size();) {
+                const LRItem& item = items[k];
+                const SymbolSpan rhs = g.right(item.prod);
+                ss << g.name(g.left(item.prod)) << " -> ";
+                for (std::uint32_t j = 0; j < rhs.size(); ++j) {
+                    if (j == item.dot_position) {
+                        ss << "• ";
+                    }
+                    ss << g.name(rhs[j]) << " ";
+                }
+                if (item.dot_position == rhs.size()) {
+                    ss << "• ";
+                }
+                ss << ", ";
+
+                // 输出所有lookahead，用"/"分隔
+                std::size_t end = k;
+                for (; end < items.size() && items[end].prod == item.prod && items[end].dot_position == item.dot_position;
+                     ++end) {
+                    if (end != k) {
+                        ss << "/";
+                    }
+                    ss << g.name(items[end].lookahead);
+                }
+                ss << "\\n";
+                k = end;
             }
+            ss << "\n";
         }
+    }, output_threads.get());
 
-        // 对每个符号计算GOTO
-        for (const Symbol& X : symbols) {
-            ItemSet gotoSet = computeGoto(current, X);
-
-            if (gotoSet.items.empty()) {
+    // 添加两端都被选中的转移
+    writeChunked(out, transitions.size(), kStateChunk * 4, [this, &g, &selected](std::ostream& ss, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const StateTransition& transition = transitions[i];
+            if (!selected[transition.from_state] || !selected[transition.to_state]) {
                 continue;
             }
-
-            // 检查是否为新项集
-            bool isNew = true;
-            int existingIndex = -1;
-
-            for (size_t i = 0; i < canonical_collection.size(); ++i) {
-                if (canonical_collection[i] == gotoSet) {
-                    isNew = false;
-                    existingIndex = i;
-                    break;
-                }
-            }
-
-            if (isNew) {
-                gotoSet.state_id = canonical_collection.size();
-                canonical_collection.push_back(gotoSet);
-                worklist.push_back(gotoSet);
-
-                // 添加转移
-                transitions.push_back({ current.state_id, gotoSet.state_id, X });
-            } else {
-                // 添加到已有项集的转移
-                transitions.push_back({ current.state_id, existingIndex, X });
-            }
+            ss << "State" << transition.from_state << " --> ";
+            ss << "State" << transition.to_state << " : ";
+            ss << g.name(transition.symbol) << "\n";
         }
-    }
+    }, output_threads.get());
 
-    std::cout << "规范项集族构建完成, 共 " << canonical_collection.size() << " 个状态, "
-              << transitions.size() << " 个转移" << std::endl;
+    out << "@enduml\n";
 }
 
-std::string LRGenerator::toPlantUML() const
+std::vector<int> LRGenerator::exportStates(const ExportFilter& filter) const
 {
-    std::stringstream ss;
-    ss << "@startuml\n";
-    ss << "[*] --> State0\n";
-
-    // 添加所有状态及其项集内容
-    for (const ItemSet& itemSet : canonical_collection) {
-        ss << "State" << itemSet.state_id << " : ";
-
-        // 使用一个映射来分组相同产生式但不同lookahead的项
-        std::map<std::string, std::vector<Symbol>> groupedItems;
-
-        // 分组项
-        for (const LRItem& item : itemSet.items) {
-            // 构建产生式和点号位置的唯一表示（作为键）
-            std::stringstream itemKey;
-            itemKey << item.prod.left.name << " -> ";
-
-            // 右侧包含点号位置
-            for (size_t i = 0; i < item.prod.right.size(); ++i) {
-                if (i == item.dot_position) {
-                    itemKey << "• ";
-                }
-                itemKey << item.prod.right[i].name << " ";
-            }
-
-            // 如果点号在最右边
-            if (item.dot_position == item.prod.right.size()) {
-                itemKey << "• ";
-            }
-
-            // 将lookahead添加到对应键的集合中
-            groupedItems[itemKey.str()].push_back(item.lookahead);
+    const int count = static_cast<int>(canonical_collection.size());
+    std::vector<int> states;
+    if (filter.selectsAll()) {
+        states.resize(count);
+        for (int state = 0; state < count; ++state) {
+            states[state] = state;
         }
+        return states;
+    }
 
-        // 现在输出分组后的项
-        for (const auto& group : groupedItems) {
-            ss << group.first << ", ";
-
-            // 输出所有lookahead，用"/"分隔
-            for (size_t i = 0; i < group.second.size(); ++i) {
-                ss << group.second[i].name;
-                if (i < group.second.size() - 1) {
-                    ss << "/";
-                }
-            }
-            ss << "\\n";
+    // 从筛选出的状态出发，沿转移的正反两个方向广度优先扩展 hops 步
+    std::vector<int> distance(count, -1);
+    std::vector<int> queue;
+    auto seed = [&distance, &queue](int state) {
+        if (distance[state] < 0) {
+            distance[state] = 0;
+            queue.push_back(state);
+        }
+    };
+    for (const auto& range : filter.ranges) {
+        for (int state = range.first; state <= std::min(range.second, count - 1); ++state) {
+            seed(state);
         }
-        ss << "\n";
     }
-
-    // 添加所有转移
-    for (const StateTransition& transition : transitions) {
-        ss << "State" << transition.from_state << " --> ";
-        ss << "State" << transition.to_state << " : ";
-        ss << transition.symbol.name << "\n";
+    if (filter.conflicts) {
+        for (const ConflictRecord& conflict : conflicts) {
+            seed(conflict.state);
+        }
     }
-
-    ss << "@enduml\n";
-    return ss.str();
-}
-
-// 获取所有终结符（按照符号id排序）
-std::vector<Symbol> LRGenerator::getSortedTerminals() const
-{
-    std::vector<Symbol> terminals;
-
-    terminals.push_back(parser.getSymbol("$"));
-
-    for (const auto& [name, symbol] : parser.symbol_table) {
-        if (name == "$" || name == "ε") {
-            continue;
+    if (filter.hops > 0 && !queue.empty()) {
+        std::vector<std::vector<int>> neighbors(count);
+        for (const StateTransition& transition : transitions) {
+            neighbors[transition.from_state].push_back(transition.to_state);
+            neighbors[transition.to_state].push_back(transition.from_state);
         }
-        if (symbol.type == ElementType::TOKEN || symbol.type == ElementType::LITERAL) {
-            terminals.push_back(symbol);
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const int state = queue[head];
+            if (distance[state] == filter.hops) {
+                continue;
+            }
+            for (int next : neighbors[state]) {
+                if (distance[next] < 0) {
+                    distance[next] = distance[state] + 1;
+                    queue.push_back(next);
+                }
+            }
         }
     }
 
-    std::sort(terminals.begin() + 1, terminals.end(), [](const Symbol& a, const Symbol& b) {
-        return a.id < b.id;
-    });
-
-    return terminals;
-}
-
-// 获取所有非终结符（按名称排序）
-std::vector<Symbol> LRGenerator::getSortedNonTerminals() const
-{
-    std::vector<Symbol> nonTerminals;
-
-    for (const auto& [name, symbol] : parser.symbol_table) {
-        if (symbol.type == ElementType::NON_TERMINAL && name != "S'") {
-            nonTerminals.push_back(symbol);
+    for (int state = 0; state < count; ++state) {
+        if (distance[state] >= 0) {
+            states.push_back(state);
         }
     }
-
-    // 按名称排序
-    std::sort(nonTerminals.begin(), nonTerminals.end(), [](const Symbol& a, const Symbol& b) {
-        return a.name < b.name;
-    });
-
-    return nonTerminals;
+    return states;
 }
 
-std::vector<int> LRGenerator::computeRawTokenValues(const std::vector<Symbol>& terminals) const
+std::vector<int> LRGenerator::computeRawTokenValues() const
 {
-    std::vector<int> values(terminals.size(), 0);
+    const Grammar& g = *grammar;
+    std::vector<int> values(g.terminalCount(), 0);
     int nextTokenValue = 256;
 
-    for (size_t i = 0; i < terminals.size(); ++i) {
-        const Symbol& sym = terminals[i];
-
-        if (i == 0) {
+    for (SymbolId i = 0; i < g.terminalCount(); ++i) {
+        if (i == Grammar::kEndSymbol) {
             values[i] = 0; // $ 对应 EOF
             continue;
         }
 
-        if (sym.type == ElementType::LITERAL) {
-            values[i] = parseLiteralTokenValue(sym.name);
+        if (g.kind(i) == ElementType::LITERAL) {
+            values[i] = parseLiteralTokenValue(g.name(i));
         } else {
             values[i] = nextTokenValue++;
         }
     }
 
+    // 多字符字面量的编码可能与具名终结符相同
+    std::unordered_map<int, SymbolId> owners;
+    for (SymbolId i = 0; i < g.terminalCount(); ++i) {
+        auto inserted = owners.emplace(values[i], i);
+        if (!inserted.second) {
+            throw std::runtime_error("终结符 " + g.name(i) + " 与 " + g.name(inserted.first->second)
+                + " 的编码相同: " + std::to_string(values[i]));
+        }
+    }
+
     return values;
 }
 
@@ -1241,11 +1932,15 @@ int LRGenerator::parseLiteralTokenValue(const std::string& literal) const
         }
     };
 
+    // 多字符字面量按字节拼接: 'ab' = ('a' << 8) | 'b'，最多3个字符以保证编码为正数
     size_t pos = 0;
     int value = 0;
+    int count = 0;
     while (pos < content.size()) {
-        unsigned char ch = parseEscape(content, pos);
-        value = (value << 8) | ch;
+        if (++count > 3) {
+            throw std::runtime_error("字面量符号最多包含3个字符: " + literal);
+        }
+        value = (value << 8) | parseEscape(content, pos);
     }
 
     return value;
@@ -1271,17 +1966,17 @@ std::string LRGenerator::actionEntryToString(const ActionEntry& entry) const
 // 找到产生式的字符串表示
 std::string LRGenerator::getProductionString(int index) const
 {
-    if (index >= 0 && index < parser.productions.size()) {
-        const Production& prod = parser.productions[index];
+    const Grammar& g = *grammar;
+    if (index >= 0 && index < static_cast<int>(g.productionCount())) {
         std::stringstream ss;
 
-        ss << prod.left.name << " -> ";
+        ss << g.name(g.left(index)) << " -> ";
 
-        if (prod.right.empty()) {
+        if (g.right(index).empty()) {
             ss << "ε";
         } else {
-            for (const auto& symbol : prod.right) {
-                ss << symbol.name << " ";
+            for (SymbolId symbol : g.right(index)) {
+                ss << g.name(symbol) << " ";
             }
         }
 
@@ -1294,7 +1989,7 @@ std::string LRGenerator::getProductionString(int index) const
 // 从Union代码中提取YYSTYPE定义
 std::string LRGenerator::extractYYSTYPE() const
 {
-    std::string unionCode = parser.union_code;
+    std::string unionCode = grammar->unionCode();
     if (unionCode.empty()) {
         // 没有定义union，返回默认的YYSTYPE
         return "typedef int YYSTYPE;";
@@ -1314,23 +2009,39 @@ std::string LRGenerator::extractYYSTYPE() const
 }
 
 /// 将ACTION和GOTO表导出为Markdown格式
-std::string LRGenerator::toMarkdownTable() const
+std::string LRGenerator::toMarkdownTable(const ExportFilter& filter) const
+{
+    std::ostringstream ss;
+    writeMarkdownTable(ss, filter);
+    return ss.str();
+}
+
+void LRGenerator::writeMarkdownTable(std::ostream& ss, const ExportFilter& filter) const
 {
-    std::stringstream ss;
+    const Grammar& g = *grammar;
 
-    std::vector<Symbol> terminals = getSortedTerminals();
-    std::vector<Symbol> nonTerminals = getSortedNonTerminals();
+    const std::uint32_t terminalCount = g.terminalCount();
+    const std::uint32_t nonTerminalCount = g.nonTerminalCount();
+    const std::vector<int> states = exportStates(filter);
 
     // 生成标题和基本信息
     ss << "# LR(1) 分析表\n\n";
     ss << "## 基本信息\n\n";
     ss << "- 状态数量: " << canonical_collection.size() << "\n";
-    ss << "- 终结符数量: " << terminals.size() - 1 << " (不含 $)\n";
+    if (!filter.selectsAll()) {
+        ss << "- 导出状态数量: " << states.size() << "\n";
+    }
+    std::vector<bool> conflictStates(canonical_collection.size(), false);
+    for (const ConflictRecord& conflict : conflicts) {
+        conflictStates[conflict.state] = true;
+    }
+    ss << "- 冲突状态数量: " << std::count(conflictStates.begin(), conflictStates.end(), true) << "\n";
+    ss << "- 终结符数量: " << terminalCount - 1 << " (不含 $)\n";
 
     int literalCount = 0;
     int namedTokenCount = 0;
-    for (size_t i = 1; i < terminals.size(); ++i) {
-        if (terminals[i].type == ElementType::LITERAL) {
+    for (SymbolId i = 1; i < terminalCount; ++i) {
+        if (g.kind(i) == ElementType::LITERAL) {
             literalCount++;
         } else {
             namedTokenCount++;
@@ -1339,174 +2050,227 @@ std::string LRGenerator::toMarkdownTable() const
 
     ss << "- 其中字面量数量: " << literalCount << "\n";
     ss << "- 其中Token数量: " << namedTokenCount << "\n";
-    ss << "- 非终结符数量: " << nonTerminals.size() << "\n";
-    ss << "- 产生式数量: " << parser.productions.size() << "\n\n";
+    ss << "- 非终结符数量: " << nonTerminalCount << "\n";
+    ss << "- 产生式数量: " << g.productionCount() << "\n\n";
 
     // 列出所有产生式
     ss << "## 产生式列表\n\n";
-    for (size_t i = 0; i < parser.productions.size(); ++i) {
-        const Production& prod = parser.productions[i];
-        ss << "- (" << i << ") " << prod.left.name << " -> ";
+    for (ProductionId i = 0; i < g.productionCount(); ++i) {
+        const SymbolSpan rhs = g.right(i);
+        ss << "- (" << i << ") " << g.name(g.left(i)) << " -> ";
 
-        if (prod.right.empty()) {
+        if (rhs.empty()) {
             ss << "ε";
         } else {
-            for (size_t j = 0; j < prod.right.size(); ++j) {
-                ss << prod.right[j].name;
+            for (std::uint32_t j = 0; j < rhs.size(); ++j) {
+                ss << g.name(rhs[j]);
                 // 只在非最后一个符号后添加空格
-                if (j < prod.right.size() - 1) {
+                if (j < rhs.size() - 1) {
                     ss << " ";
                 }
             }
         }
 
         // 添加优先级和结合性信息（如果有）
-        if (prod.precedence > 0) {
-            ss << " [优先级: " << prod.precedence << "]";
+        if (g.productionPrecedence(i) > 0) {
+            ss << " [优先级: " << g.productionPrecedence(i) << "]";
         }
 
         ss << "\n";
     }
     ss << "\n";
 
-    // 生成ACTION表
-    ss << "## ACTION表\n\n";
-
-    // 收集有动作项的终结符
-    std::vector<std::pair<int, Symbol>> usedTerminals;
-    usedTerminals.push_back({ 0, terminals[0] }); // $符号总是包含的
-
-    for (int i = 1; i < terminals.size(); ++i) {
-        bool used = false;
-        for (int state = 0; state < canonical_collection.size(); ++state) {
-            if (action_table.find(state) != action_table.end() && action_table.at(state).find(terminals[i]) != action_table.at(state).end() && action_table.at(state).at(terminals[i]).type != ActionType::ERROR) {
-                usedTerminals.push_back({ i, terminals[i] });
-                used = true;
-                break;
+    if (filter.sparse) {
+        // 稀疏格式：每个状态一行，只列出非空表项，大小与表项数成正比
+        ss << "## ACTION/GOTO表\n\n";
+        ss << "| 状态 | ACTION | GOTO |\n";
+        ss << "| --- | --- | --- |\n";
+        writeChunked(ss, states.size(), kStateChunk, [this, &g, &states, terminalCount, nonTerminalCount](std::ostream& out, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const int state = states[i];
+                out << "| " << state << " |";
+                const char* separator = " ";
+                for (SymbolId term = 0; term < terminalCount; ++term) {
+                    const ActionEntry& entry = action_table[state][term];
+                    if (entry.type != ActionType::ERROR) {
+                        out << separator;
+                        writeCellName(out, g.name(term));
+                        out << ": " << actionEntryToString(entry);
+                        separator = ", ";
+                    }
+                }
+                out << " |";
+                separator = " ";
+                for (std::uint32_t nonTerminal = 0; nonTerminal < nonTerminalCount; ++nonTerminal) {
+                    if (goto_table[state][nonTerminal] >= 0) {
+                        out << separator;
+                        writeCellName(out, g.name(terminalCount + nonTerminal));
+                        out << ": " << goto_table[state][nonTerminal];
+                        separator = ", ";
+                    }
+                }
+                out << " |\n";
+            }
+        }, output_threads.get());
+        ss << "\n";
+    } else {
+        // 一次扫描选中的状态，收集有动作项的终结符和有转移的非终结符作为表列
+        std::vector<bool> terminalUsed(terminalCount, false);
+        std::vector<bool> nonTerminalUsed(nonTerminalCount, false);
+        terminalUsed[Grammar::kEndSymbol] = true; // $符号总是包含的
+        for (int state : states) {
+            for (SymbolId term = 0; term < terminalCount; ++term) {
+                if (action_table[state][term].type != ActionType::ERROR) {
+                    terminalUsed[term] = true;
+                }
+            }
+            for (std::uint32_t nonTerminal = 0; nonTerminal < nonTerminalCount; ++nonTerminal) {
+                if (goto_table[state][nonTerminal] >= 0) {
+                    nonTerminalUsed[nonTerminal] = true;
+                }
+            }
+        }
+        std::vector<SymbolId> usedTerminals;
+        for (SymbolId term = 0; term < terminalCount; ++term) {
+            if (terminalUsed[term]) {
+                usedTerminals.push_back(term);
+            }
+        }
+        std::vector<std::uint32_t> usedNonTerminals;
+        for (std::uint32_t nonTerminal = 0; nonTerminal < nonTerminalCount; ++nonTerminal) {
+            if (nonTerminalUsed[nonTerminal]) {
+                usedNonTerminals.push_back(nonTerminal);
             }
         }
-    }
-
-    // 生成表头行1: 列序号
-    ss << "| 编号 |";
-    for (const auto& [index, _] : usedTerminals) {
-        ss << " " << index << " |";
-    }
 
-    ss << "\n| --- |";
-    // 表头分隔线
-    for (size_t i = 0; i < usedTerminals.size(); ++i) {
-        ss << " --- |";
-    }
-    ss << "\n";
+        // 生成ACTION表
+        ss << "## ACTION表\n\n";
 
-    // 生成表头行2: 终结符名称
-    ss << "| 状态 |";
-    for (const auto& [_, term] : usedTerminals) {
-        ss << " " << term.name << " |";
-    }
-    ss << "\n";
+        // 生成表头行1: 列序号
+        ss << "| 编号 |";
+        for (SymbolId index : usedTerminals) {
+            ss << " " << index << " |";
+        }
 
-    // ACTION表内容
-    for (int state = 0; state < canonical_collection.size(); ++state) {
-        bool hasAction = false;
-        std::stringstream rowss;
-        rowss << "| " << state << " |";
-
-        for (const auto& [index, term] : usedTerminals) {
-            if (action_table.find(state) != action_table.end() && action_table.at(state).find(term) != action_table.at(state).end()) {
-
-                const ActionEntry& entry = action_table.at(state).at(term);
-                if (entry.type != ActionType::ERROR) {
-                    rowss << " " << actionEntryToString(entry) << " |";
-                    hasAction = true;
-                } else {
-                    rowss << " |";
-                }
-            } else {
-                rowss << " |";
-            }
+        ss << "\n| --- |";
+        // 表头分隔线
+        for (size_t i = 0; i < usedTerminals.size(); ++i) {
+            ss << " --- |";
         }
+        ss << "\n";
 
-        // 只输出有动作的行
-        if (hasAction) {
-            ss << rowss.str() << "\n";
+        // 生成表头行2: 终结符名称
+        ss << "| 状态 |";
+        for (SymbolId term : usedTerminals) {
+            ss << " ";
+            writeCellName(ss, g.name(term));
+            ss << " |";
         }
-    }
-    ss << "\n";
+        ss << "\n";
 
-    // 生成GOTO表
-    ss << "## GOTO表\n\n";
-    ss << "| 状态 |";
+        // ACTION表内容，按状态分块并行格式化，只输出有动作的行
+        writeChunked(ss, states.size(), kStateChunk, [this, &states, &usedTerminals](std::ostream& out, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const int state = states[i];
+                const std::vector<ActionEntry>& row = action_table[state];
+                if (std::none_of(usedTerminals.begin(), usedTerminals.end(),
+                        [&row](SymbolId term) { return row[term].type != ActionType::ERROR; })) {
+                    continue;
+                }
 
-    // GOTO表头：非终结符
-    for (const auto& nonTerminal : nonTerminals) {
-        ss << " " << nonTerminal.name << " |";
-    }
-    ss << "\n| --- |";
+                out << "| " << state << " |";
+                for (SymbolId term : usedTerminals) {
+                    const ActionEntry& entry = row[term];
+                    if (entry.type != ActionType::ERROR) {
+                        out << " " << actionEntryToString(entry) << " |";
+                    } else {
+                        out << " |";
+                    }
+                }
+                out << "\n";
+            }
+        }, output_threads.get());
+        ss << "\n";
 
-    // 表头分隔线
-    for (size_t i = 0; i < nonTerminals.size(); ++i) {
-        ss << " --- |";
-    }
-    ss << "\n";
+        // 生成GOTO表
+        ss << "## GOTO表\n\n";
+        ss << "| 状态 |";
 
-    // GOTO表内容：每个状态对每个非终结符的转移
-    for (int state = 0; state < canonical_collection.size(); ++state) {
-        ss << "| " << state << " |";
+        // GOTO表头：有转移的非终结符
+        for (std::uint32_t nonTerminal : usedNonTerminals) {
+            ss << " ";
+            writeCellName(ss, g.name(terminalCount + nonTerminal));
+            ss << " |";
+        }
+        ss << "\n| --- |";
 
-        for (const auto& nonTerminal : nonTerminals) {
-            if (goto_table.find(state) != goto_table.end() && goto_table.at(state).find(nonTerminal) != goto_table.at(state).end()) {
-                ss << " " << goto_table.at(state).at(nonTerminal) << " |";
-            } else {
-                ss << " |";
-            }
+        // 表头分隔线
+        for (size_t i = 0; i < usedNonTerminals.size(); ++i) {
+            ss << " --- |";
         }
+        ss << "\n";
 
+        // GOTO表内容：每个状态对每个非终结符的转移
+        writeChunked(ss, states.size(), kStateChunk, [this, &states, &usedNonTerminals](std::ostream& out, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const int state = states[i];
+                out << "| " << state << " |";
+
+                for (std::uint32_t nonTerminal : usedNonTerminals) {
+                    if (goto_table[state][nonTerminal] >= 0) {
+                        out << " " << goto_table[state][nonTerminal] << " |";
+                    } else {
+                        out << " |";
+                    }
+                }
+
+                out << "\n";
+            }
+        }, output_threads.get());
         ss << "\n";
     }
-    ss << "\n";
 
     // 添加规约产生式的详细信息
     ss << "## 规约说明\n\n";
     ss << "| 规约动作 | 产生式 | 说明 |\n";
     ss << "| --- | --- | --- |\n";
-    for (size_t i = 0; i < parser.productions.size(); ++i) {
-        const Production& prod = parser.productions[i];
-        ss << "| r" << i << " | " << prod.left.name << " -> ";
+    for (ProductionId i = 0; i < g.productionCount(); ++i) {
+        const SymbolSpan rhs = g.right(i);
+        ss << "| r" << i << " | " << g.name(g.left(i)) << " -> ";
 
-        if (prod.right.empty()) {
+        if (rhs.empty()) {
             ss << "ε";
         } else {
-            for (size_t j = 0; j < prod.right.size(); ++j) {
-                ss << prod.right[j].name;
+            for (std::uint32_t j = 0; j < rhs.size(); ++j) {
+                ss << g.name(rhs[j]);
                 // 只在非最后一个符号后添加空格
-                if (j < prod.right.size() - 1) {
+                if (j < rhs.size() - 1) {
                     ss << " ";
                 }
             }
         }
 
-        ss << " | 规约为 " << prod.left.name;
+        ss << " | 规约为 " << g.name(g.left(i));
 
         // 添加语义动作提示（如果有）
-        if (!prod.semantic_action.empty()) {
+        if (!g.semanticAction(i).empty()) {
             ss << "，执行语义动作";
         }
 
         ss << " |\n";
     }
-
-    // 去除最后一个多余的换行符
-    std::string result = ss.str();
-
-    return result;
 }
 
 // 导出C语言头文件
 std::string LRGenerator::generateHeaderFile(const std::string& filename) const
 {
-    std::stringstream ss;
+    std::ostringstream ss;
+    writeHeaderFile(ss, filename);
+    return ss.str();
+}
+
+void LRGenerator::writeHeaderFile(std::ostream& ss, const std::string& filename) const
+{
 
     std::string headerGuard = filename;
     std::transform(headerGuard.begin(), headerGuard.end(), headerGuard.begin(),
@@ -1527,6 +2291,20 @@ std::string LRGenerator::generateHeaderFile(const std::string& filename) const
     ss << "#endif\n";
     ss << "#if YYDEBUG\n";
     ss << "extern int yydebug;\n";
+    ss << "#endif\n";
+    ss << "#if YYDEBUG && defined(YYTRACE_RING)\n";
+    ss << "#include <stdio.h>\n";
+    ss << "/* 环形缓冲区中的分析事件，value 为读入的 token、目标状态或规则号 */\n";
+    ss << "enum yytrace_kind { YYTRACE_TOKEN = 1, YYTRACE_SHIFT, YYTRACE_REDUCE, YYTRACE_GOTO, YYTRACE_ACCEPT, YYTRACE_ERROR };\n";
+    ss << "typedef struct yytrace_event {\n";
+    ss << "  int kind;  /* enum yytrace_kind */\n";
+    ss << "  int state; /* 事件发生时的状态 */\n";
+    ss << "  int value;\n";
+    ss << "} yytrace_event;\n";
+    ss << "extern yytrace_event yytrace_ring[YYTRACE_RING];\n";
+    ss << "extern unsigned long yytrace_count;\n";
+    ss << "/* 按时间顺序把缓冲区中的事件以二进制写入 out，返回写出的事件数 */\n";
+    ss << "size_t yytrace_dump(FILE* out);\n";
     ss << "#endif\n\n";
 
     // 添加令牌类型定义
@@ -1537,19 +2315,13 @@ std::string LRGenerator::generateHeaderFile(const std::string& filename) const
     ss << "  {\n";
     ss << "    YYEOF = 0,                     /* \"文件结束\" */\n";
 
-    // 获取所有终结符并按名称排序
-    std::vector<Symbol> terminals = getSortedTerminals();
-    std::vector<int> rawValues = computeRawTokenValues(terminals);
+    const Grammar& g = *grammar;
+    std::vector<int> rawValues = computeRawTokenValues();
 
-    // 添加终结符令牌定义（不包括$和ε）
-    for (size_t i = 1; i < terminals.size(); ++i) {
-        const Symbol& terminal = terminals[i];
-        if (terminal.name == "ε") {
-            continue;
-        }
-
-        if (terminal.type == ElementType::TOKEN) {
-            ss << "    " << terminal.name << " = " << rawValues[i] << ",\n";
+    // 添加终结符令牌定义（不包括$）
+    for (SymbolId i = 1; i < g.terminalCount(); ++i) {
+        if (g.kind(i) == ElementType::TOKEN) {
+            ss << "    " << g.name(i) << " = " << rawValues[i] << ",\n";
         }
     }
 
@@ -1560,12 +2332,11 @@ std::string LRGenerator::generateHeaderFile(const std::string& filename) const
     ss << "/* 令牌定义宏 */\n";
     ss << "#define YYEOF 0\n";
 
-    for (size_t i = 1; i < terminals.size(); ++i) {
-        const Symbol& terminal = terminals[i];
-        if (terminal.type != ElementType::TOKEN || terminal.name == "ε") {
+    for (SymbolId i = 1; i < g.terminalCount(); ++i) {
+        if (g.kind(i) != ElementType::TOKEN) {
             continue;
         }
-        ss << "#define " << terminal.name << " " << rawValues[i] << "\n";
+        ss << "#define " << g.name(i) << " " << rawValues[i] << "\n";
     }
     ss << "\n";
 
@@ -1574,10 +2345,10 @@ std::string LRGenerator::generateHeaderFile(const std::string& filename) const
     ss << "#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED\n";
 
     // 从文法中提取union定义
-    if (!parser.union_code.empty()) {
+    if (!g.unionCode().empty()) {
         size_t lineNumber = 1;
         std::string unionContent;
-        std::istringstream unionStream(parser.union_code);
+        std::istringstream unionStream(g.unionCode());
         std::string line;
 
         // 跳过开头的 %{ 或 %}
@@ -1616,17 +2387,68 @@ std::string LRGenerator::generateHeaderFile(const std::string& filename) const
     }
     ss << "#endif\n\n";
 
-    // 添加外部变量声明
-    ss << "\n/* 外部变量声明 */\n";
-    ss << "extern YYSTYPE yylval;\n\n";
+    if (g.pureParser()) {
+        // 可重入解析器: 没有全局状态，每次解析使用调用者提供的上下文
+        ss << "\n/* 可重入解析器 (%define api.pure) */\n";
+        ss << "#include <stdio.h>\n\n";
+        ss << "/* 一条语法错误 */\n";
+        ss << "typedef struct yyparse_error {\n";
+        ss << "  int line;\n";
+        ss << "  char* message;\n";
+        ss << "  char* actual_token;\n";
+        ss << "  char** expected_tokens;\n";
+        ss << "  int expected_count;\n";
+        ss << "} yyparse_error;\n\n";
+        ss << "/* 一次解析的全部状态，由调用者分配，可在不同线程中同时使用不同的上下文 */\n";
+        ss << "typedef struct yyparse_ctx {\n";
+        ss << "  void* user;         /* 调用者数据，例如可重入词法分析器的句柄 */\n";
+        ss << "  int lineno;         /* 由词法分析器维护的当前行号，记录在错误信息中 */\n";
+        ss << "  const char* text;   /* 由词法分析器维护的当前词素，记录在错误信息中 */\n";
+        ss << "  yyparse_error* errors;\n";
+        ss << "  int error_count;\n";
+        ss << "  int error_capacity;\n";
+        ss << "} yyparse_ctx;\n\n";
+        ss << "/* 初始化上下文，user 原样保存在 ctx->user 中 */\n";
+        ss << "void yyparse_ctx_init(yyparse_ctx* ctx, void* user);\n";
+        ss << "/* 清空错误与行号以便解析下一个输入，保留 user 与已分配的错误表 */\n";
+        ss << "void yyparse_ctx_reset(yyparse_ctx* ctx);\n";
+        ss << "/* 释放上下文持有的内存 */\n";
+        ss << "void yyparse_ctx_destroy(yyparse_ctx* ctx);\n";
+        ss << "/* 以 JSON 格式写出收集到的错误 */\n";
+        ss << "void yyparse_ctx_print_errors(const yyparse_ctx* ctx, FILE* out);\n\n";
+        if (g.pullParser()) {
+            ss << "/* 由使用者提供: yylex 把语义值写入 *yylvalp，yyerror 报告解析器内部错误 */\n";
+            ss << "int yylex(YYSTYPE* yylvalp, yyparse_ctx* ctx);\n";
+        } else {
+            ss << "/* 由使用者提供: yyerror 报告解析器内部错误 */\n";
+        }
+        ss << "void yyerror(yyparse_ctx* ctx, const char* msg);\n\n";
+        if (g.pullParser()) {
+            ss << "/* 解析函数声明，语义动作中可以通过 yyctx 访问上下文 */\n";
+            ss << "int yyparse(yyparse_ctx* ctx);\n\n";
+        }
+        if (g.pushParser()) {
+            ss << "/* 推送式接口 (%define api.push-pull push 或 both) */\n";
+            ss << "#define YYPUSH_MORE 4 /* yypush_parse 需要下一个 token */\n";
+            ss << "typedef struct yypstate yypstate;\n";
+            ss << "/* 创建一个解析状态，错误记录在 ctx 中；内存不足时返回 NULL */\n";
+            ss << "yypstate* yypstate_new(yyparse_ctx* ctx);\n";
+            ss << "void yypstate_delete(yypstate* ps);\n";
+            ss << "/* 推送一个 token 及其语义值（可为 NULL），输入结束时推送 YYEOF；\n";
+            ss << "   返回 YYPUSH_MORE 表示等待下一个 token，否则与 yyparse 的返回值相同，之后 ps 可开始新的解析 */\n";
+            ss << "int yypush_parse(yypstate* ps, int token, const YYSTYPE* value);\n\n";
+        }
+    } else {
+        // 添加外部变量声明
+        ss << "\n/* 外部变量声明 */\n";
+        ss << "extern YYSTYPE yylval;\n\n";
 
-    // 添加解析函数声明
-    ss << "\n/* 解析函数声明 */\n";
-    ss << "int yyparse(void);\n\n";
+        // 添加解析函数声明
+        ss << "\n/* 解析函数声明 */\n";
+        ss << "int yyparse(void);\n\n";
+    }
 
     // 添加头文件结尾保护宏
     ss << "\n#endif /* !" << headerGuard << "_INCLUDED */\n";
-
-    return ss.str();
 }
 }
\ No newline at end of file
@@ -1,41 +1,36 @@
 #include "seuyacc/lr_item.h"
+#include <functional>
 
 namespace seuyacc {
 
 bool LRItem::operator==(const LRItem& other) const
 {
     // 只需比较产生式id、点号位置和lookahead
-    return prod.id == other.prod.id && dot_position == other.dot_position && lookahead == other.lookahead;
+    return prod == other.prod && dot_position == other.dot_position && lookahead == other.lookahead;
+}
+
+bool LRItem::operator<(const LRItem& other) const
+{
+    if (prod != other.prod) {
+        return prod < other.prod;
+    }
+    if (dot_position != other.dot_position) {
+        return dot_position < other.dot_position;
+    }
+    return lookahead < other.lookahead;
 }
 
 size_t LRItem::hash() const
 {
-    // 只用产生式id、点号位置和lookahead做hash
-    size_t h1 = std::hash<int> {}(prod.id);
-    size_t h2 = std::hash<int> {}(dot_position);
-    size_t h3 = SymbolHasher {}(lookahead);
-    return ((h1 << 1) ^ h2) ^ (h3 << 2);
+    // 三个字段打包为一个64位整数再做hash
+    std::uint64_t key = (static_cast<std::uint64_t>(prod) << 40) ^ (static_cast<std::uint64_t>(dot_position) << 32) ^ lookahead;
+    return std::hash<std::uint64_t> {}(key);
 }
 
 bool ItemSet::operator==(const ItemSet& other) const
 {
-    if (items.size() != other.items.size())
-        return false;
-
-    // 检查每个项是否都存在于other中
-    for (const auto& item : items) {
-        bool found = false;
-        for (const auto& other_item : other.items) {
-            if (item == other_item) {
-                found = true;
-                break;
-            }
-        }
-        if (!found)
-            return false;
-    }
-
-    return true;
+    // 项集内的项保持有序，逐项比较即可
+    return items == other.items;
 }
 
-} // namespace seuyacc
\ No newline at end of file
+} // namespace seuyacc
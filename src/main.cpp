@@ -1,157 +1,577 @@
-#include "seuyacc/lr_generator.h"
-#include "seuyacc/parser.h"
-#include <fstream>
+#include "seuyacc/output.h"
+#include "seuyacc/seuyacc.h"
+#include "seuyacc/source.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-int main(int argc, char** argv)
-{
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// 命令行选项
+struct CliOptions {
     bool generate_plantUML = false;
     bool generate_markdown = false;
     bool generate_header = false;
     bool generate_parser = true;
+    bool generate_binary_tables = false;
+    bool generate_cpp_tables = false;
+    bool separate_tables = false;
+    bool watch = false;
+    bool verify_tables = false;
+    bool eliminate_unit_rules = false;
+    bool shift_reduce = true;
+    seuyacc::ExportFilter export_filter;
+    seuyacc::AutomatonFormat dump_automaton = seuyacc::AutomatonFormat::NONE;
+    seuyacc::TableMode table_mode = seuyacc::TableMode::COMB;
+    seuyacc::StateOrder state_order = seuyacc::StateOrder::CANONICAL;
+    std::vector<seuyacc::StateVisit> state_profile;
+    unsigned jobs = 0; // 0 表示使用硬件线程数
+    // 由 --jobs 得出、所有文法共用的分块格式化额外线程
+    std::shared_ptr<seuyacc::ThreadBudget> output_threads;
+    std::vector<std::string> input_files;
+};
+
+// 单个文法的处理结果，输出先缓存起来，保证多个文法的诊断信息互不交错
+struct GrammarJob {
     std::string input_file;
+    std::ostringstream out;
+    std::ostringstream err;
+    bool success = false;
+    bool done = false;
+};
 
-    // 解析命令行参数
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        if (arg == "--plantUML" || arg == "-p") {
-            generate_plantUML = true;
-        } else if (arg == "--markdown" || arg == "-m") {
-            generate_markdown = true;
-        } else if (arg == "--definitions" || arg == "-d") {
-            generate_header = true;
-        } else if (input_file.empty()) {
-            input_file = arg;
+// 常驻模式下每个文法的缓存：增量生成器、上一次的文法文本与已写出的文件内容
+struct GrammarSession {
+    seuyacc::IncrementalGenerator generator;
+    std::string last_text;
+    std::unordered_map<std::string, std::string> written;
+    bool initialized = false;
+};
+
+// 报告一个输出文件的关闭结果，常驻模式下记录已写入的内容
+static void reportOutput(seuyacc::OutputFile::Status status, const std::string& output_file, const std::string& error,
+    const char* success_message, const char* failure_message, std::ostream& out, std::ostream& err)
+{
+    switch (status) {
+    case seuyacc::OutputFile::Status::WRITTEN:
+        out << success_message << output_file << std::endl;
+        break;
+    case seuyacc::OutputFile::Status::UNCHANGED:
+        out << "内容未变化，保留: " << output_file << std::endl;
+        break;
+    case seuyacc::OutputFile::Status::FAILED:
+        err << failure_message << ": " << output_file << " (" << error << ")" << std::endl;
+        break;
+    }
+}
+
+// 将生成结果写入文件并报告，常驻模式下内容未变化的文件不再重写；
+// keep_unchanged 为 true 时与磁盘上的文件比较，内容相同则保留原文件（及其修改时间）
+static void writeOutput(const std::string& output_file, const std::string& content,
+    const char* success_message, const char* failure_message, std::ostream& out, std::ostream& err,
+    GrammarSession* session = nullptr, bool keep_unchanged = false)
+{
+    if (session != nullptr) {
+        auto it = session->written.find(output_file);
+        if (it != session->written.end() && it->second == content) {
+            out << "内容未变化，跳过: " << output_file << std::endl;
+            return;
         }
     }
 
-    if (input_file.empty()) {
-        std::cerr << "用法: " << argv[0] << " [选项...] <yacc文件路径>\n";
-        std::cerr << "选项:\n";
-        std::cerr << "  -p, --plantUML      生成状态机的 PlantUML 图\n";
-        std::cerr << "  -m, --markdown      生成 Markdown 格式的分析表\n";
-        std::cerr << "  -d, --definitions   生成包含令牌定义的头文件 (y.tab.h)\n";
-        return 1;
+    seuyacc::OutputFile file;
+    std::string error;
+    if (!file.open(output_file, error, keep_unchanged)) {
+        err << failure_message << ": " << output_file << " (" << error << ")" << std::endl;
+        return;
+    }
+    file << content;
+    const seuyacc::OutputFile::Status status = file.close(error);
+    reportOutput(status, output_file, error, success_message, failure_message, out, err);
+    if (session != nullptr && status != seuyacc::OutputFile::Status::FAILED) {
+        session->written[output_file] = content;
     }
+}
 
-    seuyacc::YaccParser parser;
-    if (parser.parseYaccFile(input_file)) {
-        parser.printParsedInfo();
+// 处理一个文法文件：生成分析表并写出结果文件
+// 传入 session 时复用上一次的文法与自动机，只重新生成变化的部分
+static bool processGrammar(const std::string& input_file, const CliOptions& cli, std::ostream& out, std::ostream& err,
+    GrammarSession* session = nullptr)
+{
+    // 常驻模式下编辑器可能原地改写文件，映射的文件被截断会使进程收到 SIGBUS，
+    // 因此读入缓冲区；一次性运行时直接映射
+    seuyacc::MappedFile file;
+    std::string text;
+    std::string error;
+    const bool opened = session != nullptr ? seuyacc::readFile(input_file, text, error) : file.open(input_file, error);
+    if (!opened) {
+        err << "无法打开文件: " << input_file << " (" << error << ")" << std::endl;
+        err << "解析失败!\n";
+        return false;
+    }
 
-        if (parser.productions.empty()) {
-            std::cerr << "警告: 没有解析到任何产生式规则!\n";
-            return 1;
-        }
+    // 提取输入文件的目录和文件名（不含扩展名）
+    std::string file_dir;
+    std::string file_name_without_ext;
 
-        // 生成LR(1)分析表
-        std::cout << "\n正在生成LR(1)分析表...\n";
-
-        try {
-            seuyacc::LRGenerator generator(parser);
-            generator.generateTable();
-            std::cout << "分析表生成完成\n";
-
-            // 提取输入文件的目录和文件名（不含扩展名）
-            std::string file_dir;
-            std::string file_name_without_ext;
-
-            // 1. 分离路径和文件名
-            size_t last_slash = input_file.find_last_of("/\\");
-            if (last_slash != std::string::npos) {
-                // 有路径部分
-                file_dir = input_file.substr(0, last_slash + 1);
-                file_name_without_ext = input_file.substr(last_slash + 1);
-            } else {
-                // 没有路径部分，文件在当前目录
-                file_dir = "";
-                file_name_without_ext = input_file;
-            }
+    // 1. 分离路径和文件名
+    size_t last_slash = input_file.find_last_of("/\\");
+    if (last_slash != std::string::npos) {
+        // 有路径部分
+        file_dir = input_file.substr(0, last_slash + 1);
+        file_name_without_ext = input_file.substr(last_slash + 1);
+    } else {
+        // 没有路径部分，文件在当前目录
+        file_dir = "";
+        file_name_without_ext = input_file;
+    }
+
+    // 2. 去除文件扩展名
+    size_t last_dot = file_name_without_ext.find_last_of('.');
+    if (last_dot != std::string::npos) {
+        file_name_without_ext = file_name_without_ext.substr(0, last_dot);
+    }
+
+    seuyacc::GenerateOptions options;
+    options.base_name = file_name_without_ext;
+    options.header = cli.generate_header;
+    options.parser = cli.generate_parser;
+    options.plantuml = cli.generate_plantUML;
+    options.markdown = cli.generate_markdown;
+    options.binary_tables = cli.generate_binary_tables;
+    options.cpp_tables = cli.generate_cpp_tables;
+    options.separate_tables = cli.separate_tables;
+    options.tables = false;
+    options.table_mode = cli.table_mode;
+    options.state_order = cli.state_order;
+    options.state_profile = cli.state_profile;
+    options.verify_tables = cli.verify_tables;
+    options.eliminate_unit_rules = cli.eliminate_unit_rules;
+    options.shift_reduce = cli.shift_reduce;
+    options.export_filter = cli.export_filter;
+    options.dump_automaton = cli.dump_automaton;
+    options.output_threads = cli.output_threads;
+    options.verbose = session == nullptr || !session->initialized;
 
-            // 2. 去除文件扩展名
-            size_t last_dot = file_name_without_ext.find_last_of('.');
-            if (last_dot != std::string::npos) {
-                file_name_without_ext = file_name_without_ext.substr(0, last_dot);
+    // 非常驻模式下生成结果直接流式写入文件，内存中不保留完整文本；
+    // 常驻模式仍在内存中生成，以便跳过内容未变化的文件
+    std::map<std::string, std::unique_ptr<seuyacc::OutputFile>> streamed;
+    if (session == nullptr) {
+        const std::string tables_source_name = file_name_without_ext + ".tab.tables.c";
+        options.open_output = [&](const std::string& name) -> std::ostream* {
+            auto output = std::make_unique<seuyacc::OutputFile>();
+            std::string open_error;
+            // 只修改语义动作时分析表不变，不重写以免增量构建重新编译
+            if (!output->open(file_dir + name, open_error, name == tables_source_name)) {
+                err << "无法创建输出文件: " << file_dir + name << " (" << open_error << ")" << std::endl;
+                return nullptr;
             }
+            return streamed.emplace(name, std::move(output)).first->second.get();
+        };
+    }
+    // 提交已流式写出的文件或写出内存中的结果
+    auto emit = [&](const std::string& name, const std::string& content, const char* success_message,
+                    const char* failure_message, bool keep_unchanged = false) {
+        auto it = streamed.find(name);
+        if (it == streamed.end()) {
+            writeOutput(file_dir + name, content, success_message, failure_message, out, err, session, keep_unchanged);
+            return;
+        }
+        std::string commit_error;
+        const seuyacc::OutputFile::Status status = it->second->commit(commit_error);
+        reportOutput(status, file_dir + name, commit_error, success_message, failure_message, out, err);
+    };
+
+    seuyacc::GenerateResult result;
+    if (session != nullptr) {
+        if (session->initialized && session->last_text == text) {
+            out << "文法内容未变化: " << input_file << std::endl;
+            return true;
+        }
+        session->last_text = std::move(text);
+        session->initialized = true;
+        result = session->generator.update(session->last_text, options);
+    } else {
+        result = seuyacc::generate(file.view(), options);
+    }
+    out << result.output;
+    err << result.diagnostics;
+
+    // 流式输出先写在临时文件中：生成失败时随 streamed 析构删除，原有的输出文件保持不变；
+    // 全部写完后才逐个替换，不会只更新其中一部分
+    if (!result.success) {
+        return false;
+    }
+    bool finished = true;
+    for (auto& [name, output] : streamed) {
+        std::string finish_error;
+        if (!output->finish(finish_error)) {
+            err << "无法写入输出文件: " << file_dir + name << " (" << finish_error << ")" << std::endl;
+            finished = false;
+        }
+    }
+    if (!finished) {
+        return false;
+    }
+
+    // 如果需要生成PlantUML输出
+    if (cli.generate_plantUML) {
+        emit(result.plantuml_name, result.plantuml, "PlantUML状态图已生成: ", "无法创建PlantUML输出文件");
+    }
+
+    // 如果需要生成Markdown表格
+    if (cli.generate_markdown) {
+        emit(result.markdown_name, result.markdown, "Markdown格式的LR(1)分析表已生成: ", "无法创建Markdown输出文件");
+    }
+
+    if (cli.dump_automaton != seuyacc::AutomatonFormat::NONE) {
+        emit(result.automaton_name, result.automaton, "自动机已导出: ", "无法创建自动机导出文件");
+    }
+
+    // 如果需要生成头文件
+    if (cli.generate_header) {
+        emit(result.header_name, result.header, "令牌定义头文件已生成: ", "无法创建头文件");
+    }
+
+    if (cli.generate_parser) {
+        emit(result.parser_name, result.parser_source, "解析器代码文件已生成: ", "无法创建解析器代码文件");
+        if (cli.separate_tables) {
+            emit(result.tables_source_name, result.tables_source, "分析表代码文件已生成: ", "无法创建分析表代码文件",
+                true);
+        }
+    }
+
+    if (cli.generate_binary_tables) {
+        emit(result.binary_tables_name, result.binary_tables, "二进制分析表已生成: ", "无法创建二进制分析表文件");
+    }
+
+    if (cli.generate_cpp_tables) {
+        emit(result.cpp_tables_name, result.cpp_tables, "C++分析表头文件已生成: ", "无法创建C++分析表头文件");
+    }
 
-            // 如果需要生成PlantUML输出
-            if (generate_plantUML) {
-                std::string plantUML = generator.toPlantUML();
+    return true;
+}
+
+// 输出一个文法的缓存结果，诊断信息的每一行都加上文件名前缀
+static void flushJob(const GrammarJob& job)
+{
+    std::cout << "==> " << job.input_file << " <==\n"
+              << job.out.str() << std::endl;
+
+    std::istringstream diagnostics(job.err.str());
+    std::string line;
+    while (std::getline(diagnostics, line)) {
+        std::cerr << job.input_file << ": " << line << "\n";
+    }
+    std::cerr.flush();
+}
+
+// 在线程池中处理多个文法，结果按输入顺序输出，返回失败的文法数
+static size_t processGrammars(const CliOptions& cli)
+{
+    std::vector<GrammarJob> jobs(cli.input_files.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].input_file = cli.input_files[i];
+    }
 
-                // 使用正确的文件名创建输出文件
-                std::string output_file = file_dir + file_name_without_ext + ".puml";
+    unsigned worker_count = cli.jobs != 0 ? cli.jobs : std::max(1u, std::thread::hardware_concurrency());
+    worker_count = static_cast<unsigned>(std::min<size_t>(worker_count, jobs.size()));
 
-                std::ofstream out_file(output_file);
-                if (out_file.is_open()) {
-                    out_file << plantUML;
-                    out_file.close();
-                    std::cout << "PlantUML状态图已生成: " << output_file << std::endl;
-                } else {
-                    std::cerr << "无法创建PlantUML输出文件\n";
+    std::atomic<size_t> next_job { 0 };
+    std::mutex output_mutex;
+    size_t next_to_flush = 0;
+    size_t failures = 0;
+
+    auto worker = [&]() {
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            GrammarJob& job = jobs[i];
+            job.success = processGrammar(job.input_file, cli, job.out, job.err);
+
+            // 按输入顺序输出已完成的文法
+            std::lock_guard<std::mutex> lock(output_mutex);
+            job.done = true;
+            while (next_to_flush < jobs.size() && jobs[next_to_flush].done) {
+                const GrammarJob& ready = jobs[next_to_flush++];
+                flushJob(ready);
+                if (!ready.success) {
+                    failures++;
                 }
             }
+        }
+    };
 
-            // 如果需要生成Markdown表格
-            if (generate_markdown) {
-                std::string markdown_table = generator.toMarkdownTable();
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < worker_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
 
-                // 使用正确的文件名创建输出文件
-                std::string output_file = file_dir + file_name_without_ext + ".md";
+    return failures;
+}
 
-                std::ofstream out_file(output_file);
-                if (out_file.is_open()) {
-                    out_file << markdown_table;
-                    out_file.close();
-                    std::cout << "Markdown格式的LR(1)分析表已生成: " << output_file << std::endl;
-                } else {
-                    std::cerr << "无法创建Markdown输出文件\n";
-                }
+// 常驻模式：通过 inotify 监视文法文件，文件变化时增量地重新生成
+static int watchGrammars(const CliOptions& cli)
+{
+#ifdef __linux__
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "错误: 无法初始化 inotify" << std::endl;
+        return 1;
+    }
+
+    // 监视文法所在的目录，以便捕获编辑器先写临时文件再重命名的保存方式
+    std::map<int, std::string> watched_dirs;
+    std::map<std::pair<std::string, std::string>, size_t> grammar_index;
+    for (size_t i = 0; i < cli.input_files.size(); ++i) {
+        const std::string& input_file = cli.input_files[i];
+        size_t last_slash = input_file.find_last_of('/');
+        std::string dir = last_slash != std::string::npos ? input_file.substr(0, last_slash + 1) : "./";
+        std::string name = last_slash != std::string::npos ? input_file.substr(last_slash + 1) : input_file;
+
+        int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) {
+            std::cerr << "错误: 无法监视目录: " << dir << std::endl;
+            close(fd);
+            return 1;
+        }
+        watched_dirs[wd] = dir;
+        grammar_index[{ dir, name }] = i;
+    }
+
+    std::vector<GrammarSession> sessions(cli.input_files.size());
+    auto regenerate = [&](size_t i) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = processGrammar(cli.input_files[i], cli, std::cout, std::cerr, &sessions[i]);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << (ok ? "[watch] 已更新 " : "[watch] 生成失败 ") << cli.input_files[i]
+                  << "，耗时 " << elapsed.count() / 1000.0 << " ms" << std::endl;
+    };
+
+    for (size_t i = 0; i < cli.input_files.size(); ++i) {
+        regenerate(i);
+    }
+    std::cout << "[watch] 正在监视 " << cli.input_files.size() << " 个文法文件，按 Ctrl+C 退出" << std::endl;
+
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    std::set<size_t> changed;
+    while (true) {
+        // 收到事件后再等待一小段时间，合并同一次保存产生的多个事件
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, changed.empty() ? -1 : 20);
+        if (ready < 0) {
+            break;
+        }
+
+        if (ready == 0) {
+            for (size_t i : changed) {
+                regenerate(i);
             }
+            changed.clear();
+            continue;
+        }
 
-            // 如果需要生成头文件
-            if (generate_header) {
-                // 使用基本文件名作为头文件名
-                std::string header_name = file_name_without_ext + ".tab.h";
-                std::string output_file = file_dir + header_name;
-
-                std::string header_content = generator.generateHeaderFile(header_name);
-
-                std::ofstream out_file(output_file);
-                if (out_file.is_open()) {
-                    out_file << header_content;
-                    out_file.close();
-                    std::cout << "令牌定义头文件已生成: " << output_file << std::endl;
-                } else {
-                    std::cerr << "无法创建头文件: " << output_file << std::endl;
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (char* p = buffer; p < buffer + length;) {
+            auto* event = reinterpret_cast<struct inotify_event*>(p);
+            if (event->len > 0) {
+                auto it = grammar_index.find({ watched_dirs[event->wd], event->name });
+                if (it != grammar_index.end()) {
+                    changed.insert(it->second);
                 }
             }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    close(fd);
+    return 1;
+#else
+    (void)cli;
+    std::cerr << "错误: 当前平台不支持 --watch" << std::endl;
+    return 1;
+#endif
+}
+
+static void printUsage(const char* program)
+{
+    std::cerr << "用法: " << program << " [选项...] <yacc文件路径>...\n";
+    std::cerr << "选项:\n";
+    std::cerr << "  -p, --plantUML      生成状态机的 PlantUML 图\n";
+    std::cerr << "  -m, --markdown      生成 Markdown 格式的分析表\n";
+    std::cerr << "  --export-states=<列表> -p/-m 只导出列出的状态，如 0-10,42\n";
+    std::cerr << "  --export-conflicts  -p/-m 只导出发生冲突的状态（可与 --export-states 同时使用）\n";
+    std::cerr << "  --export-hops=<N>   同时导出与选中状态相距不超过 N 个转移的状态\n";
+    std::cerr << "  --export-sparse     Markdown 表每个状态一行，只列出非空表项\n";
+    std::cerr << "  --dump-automaton[=<格式>] 导出状态、核心项、转移、动作与冲突: jsonl (默认, y.automaton.jsonl) 或 binary (y.automaton.bin)\n";
+    std::cerr << "  -d, --definitions   生成包含令牌定义的头文件 (y.tab.h)\n";
+    std::cerr << "  -b, --binary-tables 生成供通用运行时映射使用的二进制分析表 (y.tables)\n";
+    std::cerr << "  --cpp               生成 C++17 constexpr 分析表头文件 (y.tab.hpp)\n";
+    std::cerr << "  --separate-tables   分析表单独输出到 y.tab.tables.c，内容未变化时不重写\n";
+    std::cerr << "  -j, --jobs <N>      使用的线程数，用于同时处理多个文法与分块生成大型输出 (默认为CPU核数)\n";
+    std::cerr << "  --tables=<模式>     分析表的存储方式: comb (行位移压缩, 默认)、rows (行共享)、color (图着色, 表最小) 或 dense (稠密数组)\n";
+    std::cerr << "  --state-order=<顺序> 状态的编号顺序: canonical (默认)、bfs 或 dfs\n";
+    std::cerr << "  --state-profile=<文件> 按插桩解析器 (-DYYPROFILE) 写出的访问次数重新编号状态\n";
+    std::cerr << "  --eliminate-unit-rules 消除没有语义动作的单元规约 (如 A: B;)，减少规约与GOTO的次数；\n";
+    std::cerr << "                      只用于生成的C解析器，-b 与 --cpp 的分析表保留全部规则，宿主的回调照常调用\n";
+    std::cerr << "  --no-shift-reduce      不合并移入与紧随其后的规约（生成的解析器逐个进入只有规约的状态）\n";
+    std::cerr << "  --verify-tables     校验压缩后的分析表与稠密表逐项一致\n";
+    std::cerr << "  -w, --watch         常驻并监视文法文件，修改后增量地重新生成\n";
+}
+
+int main(int argc, char** argv)
+{
+    CliOptions cli;
 
-            if (generate_parser) {
-                std::string parser_name = file_name_without_ext + ".tab.c";
-                std::string output_file = file_dir + parser_name;
-                std::string parser_content = generator.generateParserCode(parser_name);
-
-                std::ofstream parser_file(output_file);
-                if (parser_file.is_open()) {
-                    parser_file << parser_content;
-                    parser_file.close();
-                    std::cout << "解析器代码文件已生成: " << output_file << std::endl;
-                } else {
-                    std::cerr << "无法创建解析器代码文件: " << output_file << std::endl;
+    // 解析命令行参数
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--plantUML" || arg == "-p") {
+            cli.generate_plantUML = true;
+        } else if (arg == "--markdown" || arg == "-m") {
+            cli.generate_markdown = true;
+        } else if (arg.rfind("--export-states=", 0) == 0) {
+            std::string error;
+            if (!seuyacc::parseStateRanges(arg.substr(16), cli.export_filter.ranges, error)) {
+                std::cerr << "错误: --export-states " << error << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--export-conflicts") {
+            cli.export_filter.conflicts = true;
+        } else if (arg.rfind("--export-hops=", 0) == 0) {
+            try {
+                int hops = std::stoi(arg.substr(14));
+                if (hops < 0) {
+                    throw std::invalid_argument(arg);
                 }
+                cli.export_filter.hops = hops;
+            } catch (const std::exception&) {
+                std::cerr << "错误: --export-hops 需要一个非负整数参数\n";
+                printUsage(argv[0]);
+                return 1;
             }
-
-        } catch (const std::exception& e) {
-            std::cerr << "生成LR(1)分析表时发生异常: " << e.what() << std::endl;
-            return 1;
-        } catch (...) {
-            std::cerr << "生成LR(1)分析表时发生未知异常!" << std::endl;
-            return 1;
+        } else if (arg == "--export-sparse") {
+            cli.export_filter.sparse = true;
+        } else if (arg == "--dump-automaton") {
+            cli.dump_automaton = seuyacc::AutomatonFormat::JSON_LINES;
+        } else if (arg.rfind("--dump-automaton=", 0) == 0) {
+            if (!seuyacc::parseAutomatonFormat(arg.substr(17), cli.dump_automaton)) {
+                std::cerr << "错误: 未知的自动机导出格式: " << arg.substr(17) << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--definitions" || arg == "-d") {
+            cli.generate_header = true;
+        } else if (arg == "--binary-tables" || arg == "-b") {
+            cli.generate_binary_tables = true;
+        } else if (arg == "--cpp") {
+            cli.generate_cpp_tables = true;
+        } else if (arg == "--separate-tables") {
+            cli.separate_tables = true;
+        } else if (arg.rfind("--tables=", 0) == 0) {
+            if (!seuyacc::parseTableMode(arg.substr(9), cli.table_mode)) {
+                std::cerr << "错误: 未知的分析表存储方式: " << arg.substr(9) << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--state-order=", 0) == 0) {
+            if (!seuyacc::parseStateOrder(arg.substr(14), cli.state_order)) {
+                std::cerr << "错误: 未知的状态顺序: " << arg.substr(14) << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--state-profile=", 0) == 0) {
+            const std::string profile_file = arg.substr(16);
+            seuyacc::MappedFile file;
+            std::string error;
+            if (!file.open(profile_file, error)) {
+                std::cerr << "错误: 无法打开剖析文件: " << profile_file << " (" << error << ")\n";
+                return 1;
+            }
+            if (!seuyacc::parseStateProfile(file.view(), cli.state_profile, error)) {
+                std::cerr << "错误: 剖析文件 " << profile_file << " " << error << "\n";
+                return 1;
+            }
+            cli.state_order = seuyacc::StateOrder::PROFILE;
+        } else if (arg == "--eliminate-unit-rules") {
+            cli.eliminate_unit_rules = true;
+        } else if (arg == "--no-shift-reduce") {
+            cli.shift_reduce = false;
+        } else if (arg == "--verify-tables") {
+            cli.verify_tables = true;
+        } else if (arg == "--watch" || arg == "-w") {
+            cli.watch = true;
+        } else if (arg == "--jobs" || arg == "-j" || arg.rfind("--jobs=", 0) == 0) {
+            std::string value;
+            if (arg.rfind("--jobs=", 0) == 0) {
+                value = arg.substr(7);
+            } else if (i + 1 < argc) {
+                value = argv[++i];
+            }
+            try {
+                int jobs = std::stoi(value);
+                if (jobs <= 0) {
+                    throw std::invalid_argument(value);
+                }
+                cli.jobs = static_cast<unsigned>(jobs);
+            } catch (const std::exception&) {
+                std::cerr << "错误: --jobs 需要一个正整数参数\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            cli.input_files.push_back(arg);
         }
-    } else {
-        std::cerr << "解析失败!\n";
+    }
+
+    if (cli.input_files.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // --jobs 是总的线程数：并行处理文法的线程之外的部分用于分块格式化大型输出
+    const unsigned total_threads = cli.jobs != 0 ? cli.jobs : std::max(1u, std::thread::hardware_concurrency());
+    const size_t grammar_threads
+        = cli.watch ? 1 : std::min<size_t>(total_threads, std::max<size_t>(1, cli.input_files.size()));
+    cli.output_threads = std::make_shared<seuyacc::ThreadBudget>(total_threads - static_cast<unsigned>(grammar_threads));
+
+    if (cli.watch) {
+        return watchGrammars(cli);
+    }
+
+    // 单个文法直接输出，保持原有的输出格式
+    if (cli.input_files.size() == 1) {
+        return processGrammar(cli.input_files.front(), cli, std::cout, std::cerr) ? 0 : 1;
+    }
+
+    size_t failures = processGrammars(cli);
+    if (failures > 0) {
+        std::cerr << "错误: " << cli.input_files.size() << " 个文法中有 " << failures << " 个生成失败\n";
         return 1;
     }
 
+    std::cout << "全部 " << cli.input_files.size() << " 个文法生成完成\n";
     return 0;
-}
\ No newline at end of file
+}
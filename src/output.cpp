@@ -0,0 +1,243 @@
+#include "seuyacc/output.h"
+#include "seuyacc/source.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+namespace seuyacc {
+
+OutputFile::Buffer::Buffer()
+{
+    setp(storage, storage + kSize);
+}
+
+bool OutputFile::Buffer::writeAll(const char* data, std::size_t size)
+{
+    if (error != 0) {
+        return false;
+    }
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool OutputFile::Buffer::flush()
+{
+    const bool ok = writeAll(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(storage, storage + kSize);
+    return ok;
+}
+
+void OutputFile::Buffer::reset()
+{
+    setp(storage, storage + kSize);
+    error = 0;
+}
+
+OutputFile::Buffer::int_type OutputFile::Buffer::overflow(int_type ch)
+{
+    if (!flush()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize OutputFile::Buffer::xsputn(const char* s, std::streamsize n)
+{
+    const std::size_t size = static_cast<std::size_t>(n);
+    if (size <= static_cast<std::size_t>(epptr() - pptr())) {
+        std::memcpy(pptr(), s, size);
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    // 放不下时先写出缓冲区，大块数据不再经过缓冲区
+    if (!flush()) {
+        return 0;
+    }
+    if (size >= kSize) {
+        return writeAll(s, size) ? n : 0;
+    }
+    std::memcpy(pptr(), s, size);
+    pbump(static_cast<int>(n));
+    return n;
+}
+
+int OutputFile::Buffer::sync()
+{
+    return flush() ? 0 : -1;
+}
+
+OutputFile::OutputFile()
+    : std::ostream(nullptr)
+{
+    rdbuf(&buffer);
+}
+
+OutputFile::~OutputFile()
+{
+    discard();
+}
+
+bool OutputFile::open(const std::string& output_path, std::string& error, bool keep)
+{
+    discard();
+    path = output_path;
+    temp_path = output_path + ".tmp";
+    keep_unchanged = keep;
+
+    buffer.fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (buffer.fd < 0) {
+        error = std::strerror(errno);
+        temp_path.clear();
+        setstate(std::ios::badbit);
+        return false;
+    }
+    buffer.reset();
+    clear();
+    return true;
+}
+
+bool OutputFile::finish(std::string& error)
+{
+    if (buffer.fd < 0) {
+        error = "文件未打开";
+        return false;
+    }
+    buffer.flush();
+    int failure = buffer.error;
+    if (::close(buffer.fd) != 0 && failure == 0) {
+        failure = errno;
+    }
+    buffer.fd = -1;
+
+    if (failure != 0) {
+        error = std::strerror(failure);
+        discard();
+        return false;
+    }
+    return true;
+}
+
+OutputFile::Status OutputFile::commit(std::string& error)
+{
+    if (buffer.fd >= 0 || temp_path.empty()) {
+        error = "文件未写完";
+        return Status::FAILED;
+    }
+
+    const std::string temp = std::move(temp_path);
+    temp_path.clear();
+    if (keep_unchanged) {
+        MappedFile existing;
+        MappedFile fresh;
+        std::string ignored;
+        if (existing.open(path, ignored) && fresh.open(temp, error) && existing.view() == fresh.view()) {
+            ::unlink(temp.c_str());
+            return Status::UNCHANGED;
+        }
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        error = std::strerror(errno);
+        ::unlink(temp.c_str());
+        return Status::FAILED;
+    }
+    return Status::WRITTEN;
+}
+
+OutputFile::Status OutputFile::close(std::string& error)
+{
+    return finish(error) ? commit(error) : Status::FAILED;
+}
+
+void OutputFile::discard()
+{
+    if (buffer.fd >= 0) {
+        ::close(buffer.fd);
+        buffer.fd = -1;
+    }
+    if (!temp_path.empty()) {
+        ::unlink(temp_path.c_str());
+        temp_path.clear();
+    }
+}
+
+ThreadBudget::ThreadBudget(unsigned threads)
+    : available(threads)
+{
+}
+
+unsigned ThreadBudget::acquire(unsigned wanted)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const unsigned granted = std::min(wanted, available);
+    available -= granted;
+    return granted;
+}
+
+void ThreadBudget::release(unsigned count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    available += count;
+}
+
+void writeChunked(std::ostream& out, std::size_t count, std::size_t chunk_size,
+    const std::function<void(std::ostream& out, std::size_t begin, std::size_t end)>& format, ThreadBudget* budget)
+{
+    const std::size_t chunks = chunk_size == 0 ? 1 : (count + chunk_size - 1) / chunk_size;
+    const unsigned wanted = static_cast<unsigned>(std::min<std::size_t>(chunks - 1, UINT_MAX));
+    const unsigned helpers = chunks <= 1 || budget == nullptr ? 0 : budget->acquire(wanted);
+    if (helpers == 0) {
+        format(out, 0, count);
+        return;
+    }
+
+    // 异常时同样归还额度（已启动的线程由 future 的析构等待）
+    struct Release {
+        ThreadBudget* budget;
+        unsigned count;
+        ~Release() { budget->release(count); }
+    } release { budget, helpers };
+
+    // 每轮的第一块在调用线程中直接写入 out，其余块在额外的线程中格式化
+    const std::size_t threads = helpers + 1;
+    for (std::size_t first = 0; first < chunks; first += threads) {
+        const std::size_t last = std::min(chunks, first + threads);
+        std::vector<std::future<std::string>> parts;
+        for (std::size_t chunk = first + 1; chunk < last; ++chunk) {
+            const std::size_t begin = chunk * chunk_size;
+            const std::size_t end = std::min(count, begin + chunk_size);
+            parts.push_back(std::async(std::launch::async, [&format, begin, end] {
+                std::ostringstream part;
+                format(part, begin, end);
+                return part.str();
+            }));
+        }
+        format(out, first * chunk_size, std::min(count, (first + 1) * chunk_size));
+        for (auto& part : parts) {
+            out << part.get();
+        }
+    }
+}
+
+} // namespace seuyacc
@@ -0,0 +1,629 @@
+#include "seuyacc/parse_tables.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace seuyacc {
+
+bool parseTableMode(const std::string& name, TableMode& mode)
+{
+    if (name == "dense") {
+        mode = TableMode::DENSE;
+    } else if (name == "comb") {
+        mode = TableMode::COMB;
+    } else if (name == "rows") {
+        mode = TableMode::ROWS;
+    } else if (name == "color") {
+        mode = TableMode::COLOR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* tableModeName(TableMode mode)
+{
+    switch (mode) {
+    case TableMode::DENSE:
+        return "dense";
+    case TableMode::COMB:
+        return "comb";
+    case TableMode::ROWS:
+        return "rows";
+    case TableMode::COLOR:
+        return "color";
+    }
+    return "unknown";
+}
+
+int ParseTables::translateToken(int raw) const
+{
+    if (raw < 0) {
+        return -1;
+    }
+    if (raw < static_cast<int>(translate.size())) {
+        return translate[raw];
+    }
+    auto it = std::lower_bound(sparse_translate.begin(), sparse_translate.end(), std::make_pair(raw, -1));
+    return it != sparse_translate.end() && it->first == raw ? it->second : -1;
+}
+
+TranslateHash buildTranslateHash(const std::vector<std::pair<int, int>>& sparse)
+{
+    TranslateHash hash;
+    std::vector<bool> taken;
+    for (int modulus = std::max<int>(1, static_cast<int>(sparse.size()));; ++modulus) {
+        taken.assign(modulus, false);
+        bool collision = false;
+        for (const auto& entry : sparse) {
+            const int slot = entry.first % modulus;
+            if (taken[slot]) {
+                collision = true;
+                break;
+            }
+            taken[slot] = true;
+        }
+        if (collision) {
+            continue;
+        }
+
+        hash.modulus = modulus;
+        hash.keys.assign(modulus, -1);
+        hash.values.assign(modulus, -1);
+        for (const auto& entry : sparse) {
+            hash.keys[entry.first % modulus] = entry.first;
+            hash.values[entry.first % modulus] = entry.second;
+        }
+        return hash;
+    }
+}
+
+bool ParseTables::defaultOnly(int state) const
+{
+    if (default_reduction[state] == 0) {
+        return false;
+    }
+    for (int token = 0; token < token_count; ++token) {
+        int code = actionAt(state, token);
+        if (code != kErrorAction && !isDefaultAction(state, code)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int CombTables::action(int state, int token) const
+{
+    int n = pact[state];
+    if (n == base_ninf) {
+        return ParseTables::kErrorAction;
+    }
+    n += token;
+    if (n < 0 || n >= static_cast<int>(table.size()) || check[n] != token) {
+        return ParseTables::kErrorAction;
+    }
+    return table[n];
+}
+
+int CombTables::gotoState(int state, int nonterminal) const
+{
+    int n = pgoto[nonterminal];
+    if (n == base_ninf) {
+        return -1;
+    }
+    n += state;
+    if (n < 0 || n >= static_cast<int>(table.size()) || check[n] != state) {
+        return -1;
+    }
+    return table[n];
+}
+
+namespace {
+
+    // 待放入 table/check 的一个向量：ACTION 的一行或 GOTO 的一列
+    struct PackVector {
+        std::vector<std::pair<int, int>> entries; // (列号, 表项)，按列号升序
+        int* base;
+    };
+
+} // namespace
+
+CombTables compressComb(const ParseTables& dense)
+{
+    CombTables comb;
+    comb.pact.assign(dense.state_count, 0);
+    comb.pgoto.assign(dense.nonterminal_count, 0);
+
+    std::vector<PackVector> vectors;
+    vectors.reserve(dense.state_count + dense.nonterminal_count);
+
+    for (int state = 0; state < dense.state_count; ++state) {
+        PackVector v;
+        for (int token = 0; token < dense.token_count; ++token) {
+            int code = dense.actionAt(state, token);
+            if (code != ParseTables::kErrorAction && !dense.isDefaultAction(state, code)) {
+                v.entries.emplace_back(token, code);
+            }
+        }
+        v.base = &comb.pact[state];
+        vectors.push_back(std::move(v));
+    }
+
+    for (int nonterminal = 0; nonterminal < dense.nonterminal_count; ++nonterminal) {
+        PackVector v;
+        for (int state = 0; state < dense.state_count; ++state) {
+            int target = dense.gotoAt(state, nonterminal);
+            if (target != -1) {
+                v.entries.emplace_back(state, target);
+            }
+        }
+        v.base = &comb.pgoto[nonterminal];
+        vectors.push_back(std::move(v));
+    }
+
+    // 先放表项多、跨度大的向量，小向量更容易填进剩下的空隙
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        if (!vectors[i].entries.empty()) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&vectors](std::size_t a, std::size_t b) {
+        const auto& ea = vectors[a].entries;
+        const auto& eb = vectors[b].entries;
+        if (ea.size() != eb.size()) {
+            return ea.size() > eb.size();
+        }
+        return ea.back().first - ea.front().first > eb.back().first - eb.front().first;
+    });
+
+    // 基址可能为负（不小于 -最大列号），用偏移量把基址映射到数组下标
+    const int offset = std::max(dense.token_count, dense.state_count);
+    std::vector<bool> baseUsed;
+    std::map<std::vector<std::pair<int, int>>, int> placed;
+
+    // 已占用的槽用位图表示，候选位置一次比较64个槽
+    std::vector<std::uint64_t> used;
+    auto usedWord = [&used](std::size_t pos) {
+        const std::size_t word = pos / 64;
+        const unsigned shift = pos % 64;
+        std::uint64_t bits = word < used.size() ? used[word] >> shift : 0;
+        if (shift != 0 && word + 1 < used.size()) {
+            bits |= used[word + 1] << (64 - shift);
+        }
+        return bits;
+    };
+    std::size_t lowzero = 0; // 第一个可能空闲的槽
+
+    for (std::size_t index : order) {
+        PackVector& v = vectors[index];
+
+        auto same = placed.find(v.entries);
+        if (same != placed.end()) {
+            *v.base = same->second;
+            continue;
+        }
+
+        // 一次检查64个连续的候选位置：某一位仍为1表示该位置放得下所有表项
+        const int firstKey = v.entries.front().first;
+        std::size_t j = lowzero;
+        int base = 0;
+        while (true) {
+            std::uint64_t candidates = ~std::uint64_t(0);
+            for (const auto& entry : v.entries) {
+                candidates &= ~usedWord(j + (entry.first - firstKey));
+                if (candidates == 0) {
+                    break;
+                }
+            }
+
+            bool found = false;
+            while (candidates != 0) {
+                const unsigned bit = static_cast<unsigned>(__builtin_ctzll(candidates));
+                candidates &= candidates - 1;
+                base = static_cast<int>(j + bit) - firstKey;
+                if (base + offset >= static_cast<int>(baseUsed.size()) || !baseUsed[base + offset]) {
+                    found = true;
+                    break;
+                }
+            }
+            if (found) {
+                break;
+            }
+            j += 64;
+        }
+
+        const std::size_t last = base + v.entries.back().first;
+        if (last >= comb.table.size()) {
+            comb.table.resize(last + 1, 0);
+            comb.check.resize(last + 1, -1);
+            used.resize(last / 64 + 1, 0);
+        }
+        for (const auto& entry : v.entries) {
+            const std::size_t slot = base + entry.first;
+            used[slot / 64] |= std::uint64_t(1) << (slot % 64);
+            comb.table[slot] = entry.second;
+            comb.check[slot] = entry.first;
+        }
+        if (base + offset >= static_cast<int>(baseUsed.size())) {
+            baseUsed.resize(base + offset + 1, false);
+        }
+        baseUsed[base + offset] = true;
+
+        *v.base = base;
+        placed.emplace(v.entries, base);
+
+        while (lowzero / 64 < used.size() && (used[lowzero / 64] >> (lowzero % 64) & 1) != 0) {
+            lowzero++;
+        }
+    }
+
+    // 空向量的基址取一个比所有真实基址都小的值
+    int minBase = 0;
+    for (const auto& kv : placed) {
+        minBase = std::min(minBase, kv.second);
+    }
+    comb.base_ninf = minBase - 1;
+    for (const PackVector& v : vectors) {
+        if (v.entries.empty()) {
+            *v.base = comb.base_ninf;
+        }
+    }
+
+    return comb;
+}
+
+namespace {
+
+    // 逐项比较解码结果与稠密表，action/gotoState/defaultOnly 为压缩表的解码函数
+    // 稠密表中的错误允许解码为默认规约，allowDefaultGoto 为 true 时无转移允许解码为任意目标
+    template <typename Action, typename Goto, typename DefaultOnly>
+    bool verifyDecoded(const ParseTables& dense, Action action, Goto gotoState, DefaultOnly defaultOnly,
+        bool allowDefaultGoto, std::string& error)
+    {
+        for (int state = 0; state < dense.state_count; ++state) {
+            if (dense.defaultOnly(state) != defaultOnly(state)) {
+                std::ostringstream ss;
+                ss << "状态 " << state << " 是否只有默认规约，压缩前后不一致";
+                error = ss.str();
+                return false;
+            }
+            for (int token = 0; token < dense.token_count; ++token) {
+                int expected = dense.actionAt(state, token);
+                int actual = action(state, token);
+                if (actual == ParseTables::kErrorAction && dense.default_reduction[state] != 0) {
+                    actual = -dense.default_reduction[state];
+                }
+                if (expected == ParseTables::kErrorAction && dense.isDefaultAction(state, actual)) {
+                    continue;
+                }
+                if (expected != actual) {
+                    std::ostringstream ss;
+                    ss << "ACTION[" << state << "][" << token << "] 压缩前为 " << expected << "，压缩后为 " << actual;
+                    error = ss.str();
+                    return false;
+                }
+            }
+            for (int nonterminal = 0; nonterminal < dense.nonterminal_count; ++nonterminal) {
+                int expected = dense.gotoAt(state, nonterminal);
+                int actual = gotoState(state, nonterminal);
+                if (expected == -1 && allowDefaultGoto) {
+                    continue;
+                }
+                if (expected != actual) {
+                    std::ostringstream ss;
+                    ss << "GOTO[" << state << "][" << nonterminal << "] 压缩前为 " << expected << "，压缩后为 " << actual;
+                    error = ss.str();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+bool verifyCombTables(const ParseTables& dense, const CombTables& comb, std::string& error)
+{
+    return verifyDecoded(
+        dense,
+        [&comb](int state, int token) { return comb.action(state, token); },
+        [&comb](int state, int nonterminal) { return comb.gotoState(state, nonterminal); },
+        [&comb](int state) { return comb.pact[state] == comb.base_ninf; },
+        false, error);
+}
+
+int RowTables::gotoState(int state, int nonterminal) const
+{
+    auto begin = goto_states.begin() + goto_offsets[nonterminal];
+    auto end = goto_states.begin() + goto_offsets[nonterminal + 1];
+    auto it = std::lower_bound(begin, end, state);
+    if (it != end && *it == state) {
+        return goto_targets[it - goto_states.begin()];
+    }
+    return default_goto[nonterminal];
+}
+
+RowTables compressRows(const ParseTables& dense)
+{
+    RowTables result;
+    result.token_count = dense.token_count;
+    result.row_index.assign(dense.state_count, 0);
+
+    // 第0行为空行，只有默认规约的状态都映射到这一行
+    std::vector<int> row(dense.token_count, ParseTables::kErrorAction);
+    std::map<std::vector<int>, int> rowNumbers;
+    rowNumbers.emplace(row, 0);
+    result.rows = row;
+
+    for (int state = 0; state < dense.state_count; ++state) {
+        for (int token = 0; token < dense.token_count; ++token) {
+            int code = dense.actionAt(state, token);
+            row[token] = dense.isDefaultAction(state, code) ? ParseTables::kErrorAction : code;
+        }
+        auto inserted = rowNumbers.emplace(row, static_cast<int>(rowNumbers.size()));
+        if (inserted.second) {
+            result.rows.insert(result.rows.end(), row.begin(), row.end());
+        }
+        result.row_index[state] = inserted.first->second;
+    }
+
+    // 每一列取出现次数最多的目标状态作为默认值，其余表项作为例外
+    result.default_goto.assign(dense.nonterminal_count, -1);
+    result.goto_offsets.push_back(0);
+    // 合并移入-规约后GOTO的编码可达 state_count + 规则数
+    std::vector<int> targetCounts(dense.state_count + (dense.shift_reduce ? static_cast<int>(dense.rule_length.size()) : 0));
+    for (int nonterminal = 0; nonterminal < dense.nonterminal_count; ++nonterminal) {
+        std::fill(targetCounts.begin(), targetCounts.end(), 0);
+        for (int state = 0; state < dense.state_count; ++state) {
+            int target = dense.gotoAt(state, nonterminal);
+            if (target != -1) {
+                targetCounts[target]++;
+            }
+        }
+        auto best = std::max_element(targetCounts.begin(), targetCounts.end());
+        if (*best > 0) {
+            result.default_goto[nonterminal] = static_cast<int>(best - targetCounts.begin());
+        }
+
+        for (int state = 0; state < dense.state_count; ++state) {
+            int target = dense.gotoAt(state, nonterminal);
+            if (target != -1 && target != result.default_goto[nonterminal]) {
+                result.goto_states.push_back(state);
+                result.goto_targets.push_back(target);
+            }
+        }
+        result.goto_offsets.push_back(static_cast<int>(result.goto_states.size()));
+    }
+
+    return result;
+}
+
+bool verifyRowTables(const ParseTables& dense, const RowTables& rows, std::string& error)
+{
+    return verifyDecoded(
+        dense,
+        [&rows](int state, int token) { return rows.action(state, token); },
+        [&rows](int state, int nonterminal) { return rows.gotoState(state, nonterminal); },
+        [&rows](int state) { return rows.row_index[state] == 0; },
+        true, error);
+}
+
+int ColorTables::action(int state, int token) const
+{
+    if (!significant(state, token)) {
+        return ParseTables::kErrorAction;
+    }
+    return action_matrix[action_row_class[state] * action_columns + action_column_class[token]];
+}
+
+int ColorTables::gotoState(int state, int nonterminal) const
+{
+    return goto_matrix[goto_row_class[state] * goto_columns + goto_column_class[nonterminal]];
+}
+
+namespace {
+
+    // 无关项，不会与任何动作编码或状态号相同
+    constexpr int kDontCare = std::numeric_limits<int>::max();
+
+    // 贪心着色：同一位置上没有两个不同有效表项的向量互相兼容，合并为一类
+    // vectors 中 kDontCare 为无关项；返回每个向量的类号，merged 为各类合并后的向量
+    std::vector<int> colorVectors(const std::vector<std::vector<int>>& vectors, std::size_t width,
+        std::vector<std::vector<int>>& merged)
+    {
+        // 有效表项多的向量约束最强，先着色
+        std::vector<std::vector<std::size_t>> positions(vectors.size());
+        std::vector<std::size_t> order(vectors.size());
+        for (std::size_t i = 0; i < vectors.size(); ++i) {
+            order[i] = i;
+            for (std::size_t k = 0; k < width; ++k) {
+                if (vectors[i][k] != kDontCare) {
+                    positions[i].push_back(k);
+                }
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&positions](std::size_t a, std::size_t b) {
+            return positions[a].size() > positions[b].size();
+        });
+
+        std::vector<int> classes(vectors.size(), 0);
+        merged.clear();
+        for (std::size_t index : order) {
+            const std::vector<int>& v = vectors[index];
+            std::size_t color = 0;
+            for (; color < merged.size(); ++color) {
+                bool compatible = true;
+                for (std::size_t k : positions[index]) {
+                    if (merged[color][k] != kDontCare && merged[color][k] != v[k]) {
+                        compatible = false;
+                        break;
+                    }
+                }
+                if (compatible) {
+                    break;
+                }
+            }
+            if (color == merged.size()) {
+                merged.emplace_back(width, kDontCare);
+            }
+            for (std::size_t k : positions[index]) {
+                merged[color][k] = v[k];
+            }
+            classes[index] = static_cast<int>(color);
+        }
+        return classes;
+    }
+
+    // 先合并行，再在合并后的矩阵上合并列；剩余的无关项填0
+    void colorRowsThenColumns(const std::vector<std::vector<int>>& rows, std::size_t width, std::vector<int>& rowClass,
+        std::vector<int>& columnClass, int& columnCount, std::vector<int>& matrix)
+    {
+        std::vector<std::vector<int>> mergedRows;
+        rowClass = colorVectors(rows, width, mergedRows);
+
+        std::vector<std::vector<int>> columns(width, std::vector<int>(mergedRows.size()));
+        for (std::size_t r = 0; r < mergedRows.size(); ++r) {
+            for (std::size_t c = 0; c < width; ++c) {
+                columns[c][r] = mergedRows[r][c];
+            }
+        }
+        std::vector<std::vector<int>> mergedColumns;
+        columnClass = colorVectors(columns, mergedRows.size(), mergedColumns);
+        columnCount = static_cast<int>(mergedColumns.size());
+
+        matrix.assign(mergedRows.size() * mergedColumns.size(), 0);
+        for (std::size_t c = 0; c < mergedColumns.size(); ++c) {
+            for (std::size_t r = 0; r < mergedRows.size(); ++r) {
+                if (mergedColumns[c][r] != kDontCare) {
+                    matrix[r * mergedColumns.size() + c] = mergedColumns[c][r];
+                }
+            }
+        }
+    }
+
+    // 分别尝试先合并行与先合并列，取合并后矩阵较小的一种
+    void colorMatrix(const std::vector<std::vector<int>>& rows, std::size_t width, std::vector<int>& rowClass,
+        std::vector<int>& columnClass, int& columnCount, std::vector<int>& matrix)
+    {
+        colorRowsThenColumns(rows, width, rowClass, columnClass, columnCount, matrix);
+
+        std::vector<std::vector<int>> columns(width, std::vector<int>(rows.size()));
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            for (std::size_t c = 0; c < width; ++c) {
+                columns[c][r] = rows[r][c];
+            }
+        }
+        std::vector<int> columnFirstClass;
+        std::vector<int> rowSecondClass;
+        int rowCount = 0;
+        std::vector<int> transposed;
+        colorRowsThenColumns(columns, rows.size(), columnFirstClass, rowSecondClass, rowCount, transposed);
+        if (transposed.size() >= matrix.size()) {
+            return;
+        }
+
+        const int columnClasses = rowCount == 0 ? 0 : static_cast<int>(transposed.size()) / rowCount;
+        rowClass = rowSecondClass;
+        columnClass = columnFirstClass;
+        columnCount = columnClasses;
+        matrix.assign(transposed.size(), 0);
+        for (int c = 0; c < columnClasses; ++c) {
+            for (int r = 0; r < rowCount; ++r) {
+                matrix[r * columnClasses + c] = transposed[c * rowCount + r];
+            }
+        }
+    }
+
+} // namespace
+
+ColorTables compressColor(const ParseTables& dense)
+{
+    ColorTables result;
+
+    // ACTION: 错误与默认规约为无关项
+    std::vector<std::vector<int>> actionRows(dense.state_count, std::vector<int>(dense.token_count, kDontCare));
+    std::vector<std::vector<unsigned char>> bitmapRows(dense.state_count);
+    result.bitmap_bytes = (dense.token_count + 7) / 8;
+    for (int state = 0; state < dense.state_count; ++state) {
+        std::vector<unsigned char>& bits = bitmapRows[state];
+        bits.assign(result.bitmap_bytes, 0);
+        for (int token = 0; token < dense.token_count; ++token) {
+            int code = dense.actionAt(state, token);
+            if (code != ParseTables::kErrorAction && !dense.isDefaultAction(state, code)) {
+                actionRows[state][token] = code;
+                bits[token / 8] |= static_cast<unsigned char>(1u << (token % 8));
+            }
+        }
+    }
+    colorMatrix(actionRows, dense.token_count, result.action_row_class, result.action_column_class,
+        result.action_columns, result.action_matrix);
+
+    // 位图行去重，第0行为全0
+    std::map<std::vector<unsigned char>, int> bitmapNumbers;
+    bitmapNumbers.emplace(std::vector<unsigned char>(result.bitmap_bytes, 0), 0);
+    result.bitmaps.assign(result.bitmap_bytes, 0);
+    result.bitmap_row.assign(dense.state_count, 0);
+    for (int state = 0; state < dense.state_count; ++state) {
+        auto inserted = bitmapNumbers.emplace(bitmapRows[state], static_cast<int>(bitmapNumbers.size()));
+        if (inserted.second) {
+            result.bitmaps.insert(result.bitmaps.end(), bitmapRows[state].begin(), bitmapRows[state].end());
+        }
+        result.bitmap_row[state] = inserted.first->second;
+    }
+
+    // GOTO: 无转移为无关项
+    std::vector<std::vector<int>> gotoRows(dense.state_count, std::vector<int>(dense.nonterminal_count, kDontCare));
+    for (int state = 0; state < dense.state_count; ++state) {
+        for (int nonterminal = 0; nonterminal < dense.nonterminal_count; ++nonterminal) {
+            int target = dense.gotoAt(state, nonterminal);
+            if (target != -1) {
+                gotoRows[state][nonterminal] = target;
+            }
+        }
+    }
+    colorMatrix(gotoRows, dense.nonterminal_count, result.goto_row_class, result.goto_column_class,
+        result.goto_columns, result.goto_matrix);
+
+    return result;
+}
+
+bool verifyColorTables(const ParseTables& dense, const ColorTables& color, std::string& error)
+{
+    return verifyDecoded(
+        dense,
+        [&color](int state, int token) { return color.action(state, token); },
+        [&color](int state, int nonterminal) { return color.gotoState(state, nonterminal); },
+        [&color](int state) { return color.bitmap_row[state] == 0; },
+        true, error);
+}
+
+bool verifyTables(const ParseTables& dense, TableMode mode, std::string& error)
+{
+    if (!dense.sparse_translate.empty()) {
+        const TranslateHash hash = buildTranslateHash(dense.sparse_translate);
+        for (const auto& entry : dense.sparse_translate) {
+            const int slot = entry.first % hash.modulus;
+            if (hash.keys[slot] != entry.first || hash.values[slot] != dense.translateToken(entry.first)) {
+                error = "词法值 " + std::to_string(entry.first) + " 在翻译哈希表中查找失败";
+                return false;
+            }
+        }
+    }
+
+    switch (mode) {
+    case TableMode::COMB:
+        return verifyCombTables(dense, compressComb(dense), error);
+    case TableMode::ROWS:
+        return verifyRowTables(dense, compressRows(dense), error);
+    case TableMode::COLOR:
+        return verifyColorTables(dense, compressColor(dense), error);
+    default:
+        return true;
+    }
+}
+
+} // namespace seuyacc
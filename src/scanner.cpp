@@ -0,0 +1,222 @@
+#include "seuyacc/scanner.h"
+
+namespace seuyacc {
+
+bool Scanner::isIdentifierStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool Scanner::isIdentifierChar(char c)
+{
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+bool Scanner::atLineStart() const
+{
+    for (std::size_t i = pos; i > 0; --i) {
+        char c = text[i - 1];
+        if (c == '\n') {
+            return true;
+        }
+        if (c != ' ' && c != '\t' && c != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Scanner::advance()
+{
+    if (pos >= text.size()) {
+        return;
+    }
+    if (text[pos++] == '\n') {
+        line++;
+        column = 1;
+    } else {
+        column++;
+    }
+}
+
+void Scanner::advance(std::size_t count)
+{
+    while (count-- > 0) {
+        advance();
+    }
+}
+
+void Scanner::skipWhitespaceAndComments()
+{
+    while (!atEnd()) {
+        char c = peek();
+        if (isSpace(c)) {
+            advance();
+        } else if (c == '/' && peek(1) == '/') {
+            while (!atEnd() && peek() != '\n') {
+                advance();
+            }
+        } else if (c == '/' && peek(1) == '*') {
+            advance(2);
+            while (!atEnd() && !(peek() == '*' && peek(1) == '/')) {
+                advance();
+            }
+            advance(2);
+        } else {
+            break;
+        }
+    }
+}
+
+void Scanner::skipInlineWhitespaceAndComments()
+{
+    while (!atEnd()) {
+        char c = peek();
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            advance();
+        } else if (c == '/' && peek(1) == '/') {
+            while (!atEnd() && peek() != '\n') {
+                advance();
+            }
+        } else if (c == '/' && peek(1) == '*') {
+            advance(2);
+            while (!atEnd() && !(peek() == '*' && peek(1) == '/')) {
+                advance();
+            }
+            advance(2);
+        } else {
+            break;
+        }
+    }
+}
+
+void Scanner::skipLine()
+{
+    while (!atEnd() && peek() != '\n') {
+        advance();
+    }
+    advance();
+}
+
+bool Scanner::atLineEnd()
+{
+    skipInlineWhitespaceAndComments();
+    return atEnd() || peek() == '\n';
+}
+
+std::string_view Scanner::readIdentifier()
+{
+    std::size_t begin = pos;
+    if (!isIdentifierStart(peek())) {
+        return {};
+    }
+    while (!atEnd() && isIdentifierChar(peek())) {
+        advance();
+    }
+    return slice(begin, pos);
+}
+
+std::string_view Scanner::readWord()
+{
+    std::size_t begin = pos;
+    while (!atEnd() && !isSpace(peek()) && !(peek() == '/' && (peek(1) == '/' || peek(1) == '*'))) {
+        advance();
+    }
+    return slice(begin, pos);
+}
+
+bool Scanner::readLiteral(std::string_view& literal)
+{
+    std::size_t begin = pos;
+    advance(); // 跳过开始的单引号
+
+    bool escaped = false;
+    while (!atEnd() && peek() != '\n') {
+        char c = peek();
+        advance();
+        if (escaped) {
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '\'') {
+            literal = slice(begin, pos);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Scanner::readTag(std::string_view& tag)
+{
+    advance(); // 跳过 <
+    std::size_t begin = pos;
+    while (!atEnd() && peek() != '>' && peek() != '\n') {
+        advance();
+    }
+    if (peek() != '>') {
+        return false;
+    }
+    tag = slice(begin, pos);
+    advance(); // 跳过 >
+    return true;
+}
+
+bool Scanner::readBracedBlock(std::string_view& block)
+{
+    std::size_t begin = pos;
+    int brace_count = 1;
+    advance(); // 跳过开始的 {
+
+    char quote_type = 0; // 0表示不在引号内，'\''表示单引号，'\"'表示双引号
+    bool escaped = false; // 是否为转义字符
+    bool in_line_comment = false; // 是否在行注释中
+    bool in_block_comment = false; // 是否在块注释中
+
+    while (!atEnd()) {
+        char c = peek();
+        char next_c = peek(1);
+
+        if (escaped) {
+            // 如果是转义字符，下一个字符不做特殊处理
+            escaped = false;
+        } else if (c == '\\' && !in_line_comment && !in_block_comment) {
+            escaped = true;
+        } else if (in_line_comment) {
+            if (c == '\n') {
+                in_line_comment = false;
+            }
+        } else if (in_block_comment) {
+            if (c == '*' && next_c == '/') {
+                in_block_comment = false;
+                advance(); // 跳过 '*'
+            }
+        } else if (quote_type == 0 && c == '/' && next_c == '/') {
+            in_line_comment = true;
+            advance(); // 跳过第一个 '/'
+        } else if (quote_type == 0 && c == '/' && next_c == '*') {
+            in_block_comment = true;
+            advance(); // 跳过 '/'
+        } else if (quote_type == 0) {
+            if (c == '\'' || c == '\"') {
+                quote_type = c;
+            } else if (c == '{') {
+                brace_count++;
+            } else if (c == '}') {
+                brace_count--;
+                if (brace_count == 0) {
+                    advance(); // 跳过结束花括号
+                    block = slice(begin, pos);
+                    return true;
+                }
+            }
+        } else if (c == quote_type) {
+            quote_type = 0;
+        }
+
+        advance();
+    }
+
+    return false;
+}
+
+} // namespace seuyacc
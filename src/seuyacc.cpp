@@ -0,0 +1,256 @@
+#include "seuyacc/seuyacc.h"
+#include "seuyacc/parser.h"
+#include <algorithm>
+#include <future>
+#include <list>
+#include <sstream>
+#include <thread>
+
+namespace seuyacc {
+
+namespace {
+
+    // 一个生成结果的去向：open_output 打开的流，或写回 GenerateResult 的内存缓冲
+    class OutputSlot {
+    public:
+        OutputSlot(const GenerateOptions& options, const std::string& name, std::string& text)
+            : text(text)
+            , stream(options.open_output ? options.open_output(name) : &buffer)
+        {
+        }
+
+        bool valid() const { return stream != nullptr; }
+        std::ostream& out() { return *stream; }
+
+        // 写完后把内存缓冲交给结果，流式输出时刷新流
+        void finish()
+        {
+            if (stream == &buffer) {
+                text = buffer.str();
+            } else {
+                stream->flush();
+            }
+        }
+
+    private:
+        std::string& text;
+        std::ostringstream buffer;
+        std::ostream* stream;
+    };
+
+    // 解析文法文本，失败时返回空指针
+    std::shared_ptr<const Grammar> parseGrammar(std::string_view grammar_text, const GenerateOptions& options,
+        std::ostream& out, std::ostream& err)
+    {
+        YaccParser parser;
+        parser.setOutputStreams(out, err);
+
+        if (!parser.parseYaccSource(grammar_text)) {
+            err << "解析失败!\n";
+            return nullptr;
+        }
+        if (parser.productions.empty()) {
+            err << "警告: 没有解析到任何产生式规则!\n";
+            return nullptr;
+        }
+
+        if (options.verbose) {
+            parser.printParsedInfo();
+        }
+        return parser.grammar();
+    }
+
+    // 按选项导出分析表与各类生成结果，压缩表校验失败时返回false
+    bool emitOutputs(const Grammar& grammar, LRGenerator& generator, const GenerateOptions& options, GenerateResult& result,
+        std::ostream& out, std::ostream& err)
+    {
+        generator.setTableMode(options.table_mode);
+        // 剖析文件中的状态号在知道自动机的大小后才换算为访问次数表
+        std::size_t ignoredVisits = 0;
+        generator.setStateOrder(options.state_order, options.state_order == StateOrder::PROFILE
+                ? stateVisitCounts(options.state_profile, generator.stateCount(), ignoredVisits)
+                : std::vector<std::uint64_t>());
+        generator.setEliminateUnitRules(options.eliminate_unit_rules);
+        generator.setShiftReduce(options.shift_reduce);
+        // 未指定时调用线程之外再用满其余的硬件线程
+        std::shared_ptr<ThreadBudget> threads = options.output_threads;
+        if (!threads) {
+            threads = std::make_shared<ThreadBudget>(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        }
+        generator.setOutputThreads(threads);
+        if (ignoredVisits > 0) {
+            err << "警告: 剖析文件中有 " << ignoredVisits << " 行的状态超出自动机的 " << generator.stateCount()
+                << " 个状态，已忽略；剖析文件可能来自其他文法\n";
+        }
+
+        if (options.verify_tables) {
+            const ParseTables dense = generator.exportTables();
+            std::string error;
+            if (!verifyTables(options.shift_reduce ? fuseShiftReduce(dense) : dense, options.table_mode, error)) {
+                err << "错误: 压缩分析表校验失败: " << error << std::endl;
+                return false;
+            }
+            out << "压缩分析表校验通过\n";
+        }
+
+        if (options.tables) {
+            result.tables = generator.exportTables();
+        }
+        if (options.eliminate_unit_rules && (options.binary_tables || options.cpp_tables)) {
+            err << "警告: --eliminate-unit-rules 只用于生成的C解析器，二进制表与C++分析表保留全部单元规约，"
+                   "宿主程序的每条规则的回调都会被调用\n";
+        }
+
+        // 先打开全部输出，任何一个无法创建时不开始生成
+        std::list<OutputSlot> slots;
+        bool opened = true;
+        auto open = [&](bool wanted, const std::string& name, std::string& text) -> OutputSlot* {
+            if (!wanted) {
+                return nullptr;
+            }
+            OutputSlot& slot = slots.emplace_back(options, name, text);
+            if (!slot.valid()) {
+                err << "错误: 无法创建输出文件: " << name << std::endl;
+                opened = false;
+            }
+            return &slot;
+        };
+        OutputSlot* binarySlot = open(options.binary_tables, result.binary_tables_name, result.binary_tables);
+        OutputSlot* cppSlot = open(options.cpp_tables, result.cpp_tables_name, result.cpp_tables);
+        OutputSlot* plantumlSlot = open(options.plantuml, result.plantuml_name, result.plantuml);
+        OutputSlot* markdownSlot = open(options.markdown, result.markdown_name, result.markdown);
+        OutputSlot* automatonSlot
+            = open(options.dump_automaton != AutomatonFormat::NONE, result.automaton_name, result.automaton);
+        OutputSlot* headerSlot = open(options.header, result.header_name, result.header);
+        OutputSlot* parserSlot = open(options.parser, result.parser_name, result.parser_source);
+        OutputSlot* tablesSlot
+            = open(options.parser && options.separate_tables, result.tables_source_name, result.tables_source);
+        if (!opened) {
+            return false;
+        }
+        if ((plantumlSlot != nullptr || markdownSlot != nullptr) && !options.export_filter.selectsAll()
+            && generator.exportStates(options.export_filter).empty()) {
+            err << "警告: 导出筛选条件没有选中任何状态" << std::endl;
+        }
+
+        // 各生成结果相互独立，分别在自己的线程中生成；只有解析器代码会写进度信息到 out
+        std::vector<std::future<void>> writers;
+        auto launch = [&writers](auto task) { writers.push_back(std::async(std::launch::async, std::move(task))); };
+        if (binarySlot != nullptr || cppSlot != nullptr) {
+            launch([&] {
+                // 宿主程序按规则号回调语义动作，不使用消除了单元规约的表
+                const ParseTables tables = options.tables && !options.eliminate_unit_rules ? result.tables
+                                                                                           : generator.exportHostTables();
+                if (binarySlot != nullptr) {
+                    binarySlot->out() << serializeBinaryTables(tables);
+                    binarySlot->finish();
+                }
+                if (cppSlot != nullptr) {
+                    cppSlot->out() << generateCppTables(tables, result.cpp_tables_name);
+                    cppSlot->finish();
+                }
+            });
+        }
+        if (plantumlSlot != nullptr) {
+            launch([&] {
+                generator.writePlantUML(plantumlSlot->out(), options.export_filter);
+                plantumlSlot->finish();
+            });
+        }
+        if (markdownSlot != nullptr) {
+            launch([&] {
+                generator.writeMarkdownTable(markdownSlot->out(), options.export_filter);
+                markdownSlot->finish();
+            });
+        }
+        if (automatonSlot != nullptr) {
+            launch([&] {
+                writeAutomaton(automatonSlot->out(), grammar, generator, options.dump_automaton);
+                automatonSlot->finish();
+            });
+        }
+        if (headerSlot != nullptr) {
+            launch([&] {
+                generator.writeHeaderFile(headerSlot->out(), result.header_name);
+                headerSlot->finish();
+            });
+        }
+        if (parserSlot != nullptr) {
+            launch([&] {
+                generator.writeParserCode(parserSlot->out(), result.parser_name,
+                    tablesSlot != nullptr ? &tablesSlot->out() : nullptr);
+                parserSlot->finish();
+                if (tablesSlot != nullptr) {
+                    tablesSlot->finish();
+                }
+            });
+        }
+        // 等待全部生成完成，第一个异常在此重新抛出（其余线程由 future 的析构等待）
+        for (auto& writer : writers) {
+            writer.get();
+        }
+        return true;
+    }
+
+} // namespace
+
+GenerateResult generate(std::string_view grammar_text, const GenerateOptions& options)
+{
+    IncrementalGenerator generator;
+    return generator.update(grammar_text, options);
+}
+
+GenerateResult IncrementalGenerator::update(std::string_view grammar_text, const GenerateOptions& options)
+{
+    GenerateResult result;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    result.header_name = options.base_name + ".tab.h";
+    result.parser_name = options.base_name + ".tab.c";
+    result.binary_tables_name = options.base_name + ".tables";
+    result.cpp_tables_name = options.base_name + ".tab.hpp";
+    result.tables_source_name = options.base_name + ".tab.tables.c";
+    result.plantuml_name = options.base_name + ".puml";
+    result.markdown_name = options.base_name + ".md";
+    result.automaton_name = options.base_name + automatonExtension(options.dump_automaton);
+
+    try {
+        std::shared_ptr<const Grammar> next = parseGrammar(grammar_text, options, out, err);
+        if (next) {
+            if (generator) {
+                generator->setOutputStreams(out, err);
+            }
+
+            if (generator && generator->rebind(next)) {
+                if (grammar->samePrecedence(*next)) {
+                    out << "\n文法结构与优先级未变化，复用已有的分析表\n";
+                } else {
+                    out << "\n文法结构未变化，复用项集规范族并重建ACTION/GOTO表\n";
+                }
+            } else {
+                // 生成LR(1)分析表
+                out << "\n正在生成LR(1)分析表...\n";
+
+                auto fresh = std::make_unique<LRGenerator>(next);
+                fresh->setOutputStreams(out, err);
+                fresh->generateTable();
+                generator = std::move(fresh);
+                out << "分析表生成完成\n";
+            }
+            grammar = next;
+
+            result.success = emitOutputs(*grammar, *generator, options, result, out, err);
+        }
+    } catch (const std::exception& e) {
+        err << "生成LR(1)分析表时发生异常: " << e.what() << std::endl;
+    } catch (...) {
+        err << "生成LR(1)分析表时发生未知异常!" << std::endl;
+    }
+
+    result.output = out.str();
+    result.diagnostics = err.str();
+    return result;
+}
+
+} // namespace seuyacc
@@ -0,0 +1,76 @@
+#include "seuyacc/shift_reduce.h"
+
+namespace seuyacc {
+
+ParseTables fuseShiftReduce(const ParseTables& tables, int* fused_states)
+{
+    // 只有默认规约、且规约弹出该状态本身（右部非空）的状态会被合并；
+    // 按空产生式规约的状态仍是GOTO的起点，必须留在栈上
+    std::vector<bool> fused(tables.state_count, false);
+    for (int state = 1; state < tables.state_count; ++state) {
+        fused[state] = tables.defaultOnly(state) && tables.rule_length[tables.default_reduction[state] - 1] > 0;
+    }
+
+    // 不进入被合并的状态，求其余状态的可达性
+    std::vector<bool> reachable(tables.state_count, false);
+    std::vector<int> queue { 0 };
+    reachable[0] = true;
+    auto visit = [&](int target) {
+        if (target > 0 && target != ParseTables::kErrorAction && !fused[target] && !reachable[target]) {
+            reachable[target] = true;
+            queue.push_back(target);
+        }
+    };
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const int state = queue[head];
+        for (int token = 0; token < tables.token_count; ++token) {
+            visit(tables.actionAt(state, token));
+        }
+        for (int nonterminal = 0; nonterminal < tables.nonterminal_count; ++nonterminal) {
+            visit(tables.gotoAt(state, nonterminal));
+        }
+    }
+
+    std::vector<int> newNumber(tables.state_count, -1);
+    int count = 0;
+    for (int state = 0; state < tables.state_count; ++state) {
+        if (reachable[state]) {
+            newNumber[state] = count++;
+        }
+    }
+
+    // 转到被合并状态的编码为 新状态数 + 该状态的规约规则号
+    auto encode = [&](int target) {
+        return fused[target] ? count + tables.default_reduction[target] - 1 : newNumber[target];
+    };
+
+    ParseTables result = tables;
+    result.state_count = count;
+    result.shift_reduce = true;
+    result.action.clear();
+    result.goto_table.clear();
+    result.default_reduction.clear();
+    result.state_origin.clear();
+    for (int state = 0; state < tables.state_count; ++state) {
+        if (!reachable[state]) {
+            continue;
+        }
+        for (int token = 0; token < tables.token_count; ++token) {
+            const int code = tables.actionAt(state, token);
+            result.action.push_back(code > 0 && code != ParseTables::kErrorAction ? encode(code) : code);
+        }
+        for (int nonterminal = 0; nonterminal < tables.nonterminal_count; ++nonterminal) {
+            const int target = tables.gotoAt(state, nonterminal);
+            result.goto_table.push_back(target != -1 ? encode(target) : -1);
+        }
+        result.default_reduction.push_back(tables.default_reduction[state]);
+        result.state_origin.push_back(tables.state_origin.empty() ? state : tables.state_origin[state]);
+    }
+
+    if (fused_states != nullptr) {
+        *fused_states = tables.state_count - count;
+    }
+    return result;
+}
+
+} // namespace seuyacc
@@ -0,0 +1,135 @@
+#include "seuyacc/source.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace seuyacc {
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr))
+    , size(std::exchange(other.size, 0))
+    , mapped(std::exchange(other.mapped, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        mapped = std::exchange(other.mapped, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        error = "不是普通文件";
+        ::close(fd);
+        return false;
+    }
+
+    // 空文件无法映射，直接视为空输入
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    // 扫描器自前向后单遍读取
+    ::madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    data = static_cast<const char*>(addr);
+    size = static_cast<std::size_t>(st.st_size);
+    mapped = true;
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& text, std::string& error)
+{
+    text.clear();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        error = "不是普通文件";
+        ::close(fd);
+        return false;
+    }
+
+    // 文件大小只作为初始容量，读到文件末尾为止（期间文件可能被截断或追加）
+    text.reserve(static_cast<std::size_t>(st.st_size));
+    char buffer[65536];
+    for (;;) {
+        const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        if (count == 0) {
+            break;
+        }
+        text.append(buffer, static_cast<std::size_t>(count));
+    }
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+} // namespace seuyacc
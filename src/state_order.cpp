@@ -0,0 +1,207 @@
+#include "seuyacc/state_order.h"
+#include <algorithm>
+#include <sstream>
+
+namespace seuyacc {
+
+namespace {
+
+    // 状态 state 的所有后继：先按终结符编号的移入目标，再按非终结符序号的GOTO目标
+    template <typename Visit>
+    void forEachSuccessor(const ParseTables& tables, int state, Visit visit)
+    {
+        for (int token = 0; token < tables.token_count; ++token) {
+            const int code = tables.actionAt(state, token);
+            if (code > 0 && code != ParseTables::kErrorAction) {
+                visit(code);
+            }
+        }
+        for (int nonterminal = 0; nonterminal < tables.nonterminal_count; ++nonterminal) {
+            const int target = tables.gotoAt(state, nonterminal);
+            if (target != -1) {
+                visit(target);
+            }
+        }
+    }
+
+    std::vector<int> breadthFirst(const ParseTables& tables)
+    {
+        std::vector<int> order { 0 };
+        std::vector<bool> seen(tables.state_count, false);
+        seen[0] = true;
+        for (std::size_t head = 0; head < order.size(); ++head) {
+            forEachSuccessor(tables, order[head], [&](int next) {
+                if (!seen[next]) {
+                    seen[next] = true;
+                    order.push_back(next);
+                }
+            });
+        }
+        return order;
+    }
+
+    std::vector<int> depthFirst(const ParseTables& tables)
+    {
+        std::vector<int> order;
+        std::vector<bool> seen(tables.state_count, false);
+        std::vector<int> stack { 0 };
+        std::vector<int> successors;
+        while (!stack.empty()) {
+            const int state = stack.back();
+            stack.pop_back();
+            if (seen[state]) {
+                continue;
+            }
+            seen[state] = true;
+            order.push_back(state);
+
+            // 逆序压栈，使编号小的符号的后继先被访问
+            successors.clear();
+            forEachSuccessor(tables, state, [&](int next) { successors.push_back(next); });
+            for (auto it = successors.rbegin(); it != successors.rend(); ++it) {
+                if (!seen[*it]) {
+                    stack.push_back(*it);
+                }
+            }
+        }
+        return order;
+    }
+
+} // namespace
+
+bool parseStateOrder(const std::string& name, StateOrder& order)
+{
+    if (name == "canonical") {
+        order = StateOrder::CANONICAL;
+    } else if (name == "bfs") {
+        order = StateOrder::BFS;
+    } else if (name == "dfs") {
+        order = StateOrder::DFS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* stateOrderName(StateOrder order)
+{
+    switch (order) {
+    case StateOrder::CANONICAL:
+        return "canonical";
+    case StateOrder::BFS:
+        return "bfs";
+    case StateOrder::DFS:
+        return "dfs";
+    case StateOrder::PROFILE:
+        return "profile";
+    }
+    return "unknown";
+}
+
+std::vector<int> computeStateOrder(const ParseTables& tables, StateOrder order, const std::vector<std::uint64_t>& profile)
+{
+    std::vector<int> result;
+    switch (order) {
+    case StateOrder::BFS:
+        result = breadthFirst(tables);
+        break;
+    case StateOrder::DFS:
+        result = depthFirst(tables);
+        break;
+    case StateOrder::PROFILE: {
+        // 访问次数从高到低，次数相同（包括未访问到的状态）时保持广度优先的顺序
+        // 剖析文件按自动机中的原编号记录，消除单元规约等变换后须经 state_origin 换算
+        result = breadthFirst(tables);
+        auto count = [&profile, &tables](int state) {
+            const int origin = tables.state_origin.empty() ? state : tables.state_origin[state];
+            return static_cast<std::size_t>(origin) < profile.size() ? profile[origin] : 0;
+        };
+        std::stable_sort(result.begin() + 1, result.end(), [&](int a, int b) { return count(a) > count(b); });
+        break;
+    }
+    default:
+        break;
+    }
+
+    // 从初始状态不可达的状态（正常的自动机中不存在）按原顺序放在最后
+    std::vector<bool> placed(tables.state_count, false);
+    for (int state : result) {
+        placed[state] = true;
+    }
+    for (int state = 0; state < tables.state_count; ++state) {
+        if (!placed[state]) {
+            result.push_back(state);
+        }
+    }
+    return result;
+}
+
+ParseTables renumberStates(const ParseTables& tables, const std::vector<int>& order)
+{
+    ParseTables result = tables;
+    std::vector<int> newNumber(tables.state_count);
+    for (int next = 0; next < tables.state_count; ++next) {
+        newNumber[order[next]] = next;
+    }
+
+    for (int next = 0; next < tables.state_count; ++next) {
+        const int old = order[next];
+        for (int token = 0; token < tables.token_count; ++token) {
+            int code = tables.actionAt(old, token);
+            if (code > 0 && code != ParseTables::kErrorAction) {
+                code = newNumber[code];
+            }
+            result.action[next * tables.token_count + token] = code;
+        }
+        for (int nonterminal = 0; nonterminal < tables.nonterminal_count; ++nonterminal) {
+            const int target = tables.gotoAt(old, nonterminal);
+            result.goto_table[next * tables.nonterminal_count + nonterminal] = target != -1 ? newNumber[target] : -1;
+        }
+        result.default_reduction[next] = tables.default_reduction[old];
+    }
+
+    result.state_origin.resize(tables.state_count);
+    for (int next = 0; next < tables.state_count; ++next) {
+        result.state_origin[next] = tables.state_origin.empty() ? order[next] : tables.state_origin[order[next]];
+    }
+    return result;
+}
+
+bool parseStateProfile(std::string_view text, std::vector<StateVisit>& visits, std::string& error)
+{
+    visits.clear();
+    std::istringstream in { std::string(text) };
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        long long state = -1;
+        unsigned long long count = 0;
+        if (!(fields >> state >> count) || state < 0) {
+            error = "第 " + std::to_string(lineNumber) + " 行格式错误，应为 \"状态 次数\"";
+            return false;
+        }
+        visits.push_back({ static_cast<std::uint64_t>(state), count });
+    }
+    return true;
+}
+
+std::vector<std::uint64_t> stateVisitCounts(const std::vector<StateVisit>& visits, int state_count, std::size_t& ignored)
+{
+    std::vector<std::uint64_t> counts(static_cast<std::size_t>(std::max(state_count, 0)), 0);
+    ignored = 0;
+    for (const StateVisit& visit : visits) {
+        if (visit.state < counts.size()) {
+            counts[visit.state] += visit.count;
+        } else {
+            ignored++;
+        }
+    }
+    return counts;
+}
+
+} // namespace seuyacc
@@ -0,0 +1,221 @@
+#include "seuyacc/unit_rules.h"
+#include <algorithm>
+#include <map>
+
+namespace seuyacc {
+
+namespace {
+
+    // 消除过程中的可变状态表，新建的合并状态追加在末尾
+    struct WorkTables {
+        int token_count = 0;
+        int nonterminal_count = 0;
+        std::vector<std::vector<int>> action;
+        std::vector<std::vector<int>> gotos;
+        std::vector<int> default_reduction;
+        std::vector<bool> defaultable; // 错误表项可以按默认规约处理（不含 %nonassoc 显式错误）
+        std::vector<int> origin;
+
+        // 考虑默认规约后的实际动作
+        int effective(int state, int token) const
+        {
+            const int code = action[state][token];
+            if (code == ParseTables::kErrorAction && default_reduction[state] != 0) {
+                return -default_reduction[state];
+            }
+            return code;
+        }
+    };
+
+    bool isReduce(int code) { return code < 0 && code != ParseTables::kErrorAction; }
+
+    // 取出现次数最多的规约作为默认规约，与 exportTables 的规则一致
+    int mostFrequentReduce(const std::vector<int>& row, int ruleCount)
+    {
+        std::vector<int> counts(ruleCount, 0);
+        for (int code : row) {
+            if (isReduce(code)) {
+                counts[-code - 1]++;
+            }
+        }
+        auto best = std::max_element(counts.begin(), counts.end());
+        return *best > 0 ? static_cast<int>(best - counts.begin()) + 1 : 0;
+    }
+
+} // namespace
+
+ParseTables eliminateUnitRules(const ParseTables& tables, const std::vector<bool>& eliminable, UnitRuleStats* stats)
+{
+    const int ruleCount = static_cast<int>(tables.rule_length.size());
+    auto isUnitReduce = [&](int code) {
+        if (!isReduce(code)) {
+            return false;
+        }
+        const int rule = -code - 1;
+        return rule != 0 && rule < static_cast<int>(eliminable.size()) && eliminable[rule] && tables.rule_length[rule] == 1;
+    };
+
+    WorkTables work;
+    work.token_count = tables.token_count;
+    work.nonterminal_count = tables.nonterminal_count;
+    for (int state = 0; state < tables.state_count; ++state) {
+        auto actionRow = tables.action.begin() + static_cast<std::ptrdiff_t>(state) * tables.token_count;
+        auto gotoRow = tables.goto_table.begin() + static_cast<std::ptrdiff_t>(state) * tables.nonterminal_count;
+        work.action.emplace_back(actionRow, actionRow + tables.token_count);
+        work.gotos.emplace_back(gotoRow, gotoRow + tables.nonterminal_count);
+        work.default_reduction.push_back(tables.default_reduction[state]);
+        work.defaultable.push_back(tables.default_reduction[state] != 0
+            || std::none_of(work.action.back().begin(), work.action.back().end(), isReduce));
+        work.origin.push_back(tables.state_origin.empty() ? state : tables.state_origin[state]);
+    }
+
+    UnitRuleStats local;
+    // 内容相同的合并状态只建一个
+    std::map<std::pair<std::vector<int>, std::vector<int>>, int> mergedStates;
+
+    // 合并状态也可能经单元规约链转移，因此遍历到表尾为止
+    for (std::size_t p = 0; p < work.action.size(); ++p) {
+        const int from = static_cast<int>(p);
+        for (int symbol = 0; symbol < work.token_count + work.nonterminal_count; ++symbol) {
+            const bool terminal = symbol < work.token_count;
+            const int q = terminal ? work.action[from][symbol] : work.gotos[from][symbol - work.token_count];
+            if (q <= 0 || q == ParseTables::kErrorAction) {
+                continue;
+            }
+
+            bool hasUnit = false;
+            for (int token = 0; token < work.token_count && !hasUnit; ++token) {
+                hasUnit = isUnitReduce(work.effective(q, token));
+            }
+            if (!hasUnit) {
+                continue;
+            }
+
+            // 逐个向前看符号沿单元规约链找到最终的动作，记录途经的状态
+            std::vector<int> row(work.token_count);
+            std::vector<int> sources { q };
+            bool ok = true;
+            for (int token = 0; token < work.token_count && ok; ++token) {
+                int state = q;
+                int code = work.effective(q, token);
+                for (int steps = 0; isUnitReduce(code); ++steps) {
+                    const int next = work.gotos[from][tables.rule_lhs[-code - 1] - work.token_count];
+                    if (next < 0 || steps > tables.nonterminal_count) {
+                        ok = false;
+                        break;
+                    }
+                    if (std::find(sources.begin(), sources.end(), next) == sources.end()) {
+                        sources.push_back(next);
+                    }
+                    state = next;
+                    code = work.effective(state, token);
+                }
+                row[token] = code;
+            }
+            if (!ok) {
+                continue;
+            }
+
+            // GOTO 行取并集，同一非终结符的目标不同时放弃
+            std::vector<int> gotoRow(work.nonterminal_count, -1);
+            for (int source : sources) {
+                for (int nonterminal = 0; nonterminal < work.nonterminal_count && ok; ++nonterminal) {
+                    const int target = work.gotos[source][nonterminal];
+                    if (target == -1) {
+                        continue;
+                    }
+                    if (gotoRow[nonterminal] != -1 && gotoRow[nonterminal] != target) {
+                        ok = false;
+                    }
+                    gotoRow[nonterminal] = target;
+                }
+            }
+            if (!ok) {
+                continue;
+            }
+
+            auto key = std::make_pair(row, gotoRow);
+            auto found = mergedStates.find(key);
+            int merged;
+            if (found != mergedStates.end()) {
+                merged = found->second;
+            } else {
+                merged = static_cast<int>(work.action.size());
+                bool defaultable = true;
+                for (int source : sources) {
+                    defaultable = defaultable && work.defaultable[source];
+                }
+                work.default_reduction.push_back(defaultable ? mostFrequentReduce(row, ruleCount) : 0);
+                work.defaultable.push_back(defaultable);
+                work.origin.push_back(work.origin[q]);
+                work.action.push_back(std::move(row));
+                work.gotos.push_back(std::move(gotoRow));
+                mergedStates.emplace(std::move(key), merged);
+                local.merged_states++;
+            }
+
+            if (terminal) {
+                work.action[from][symbol] = merged;
+            } else {
+                work.gotos[from][symbol - work.token_count] = merged;
+            }
+            local.redirected++;
+        }
+    }
+
+    // 删除不再可达的状态，保持原有的相对顺序
+    std::vector<bool> reachable(work.action.size(), false);
+    std::vector<int> queue { 0 };
+    reachable[0] = true;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const int state = queue[head];
+        auto visit = [&](int next) {
+            if (next > 0 && next != ParseTables::kErrorAction && !reachable[next]) {
+                reachable[next] = true;
+                queue.push_back(next);
+            }
+        };
+        for (int code : work.action[state]) {
+            visit(code);
+        }
+        for (int target : work.gotos[state]) {
+            visit(target);
+        }
+    }
+
+    std::vector<int> newNumber(work.action.size(), -1);
+    int count = 0;
+    for (std::size_t state = 0; state < work.action.size(); ++state) {
+        if (reachable[state]) {
+            newNumber[state] = count++;
+        }
+    }
+
+    ParseTables result = tables;
+    result.state_count = count;
+    result.action.clear();
+    result.goto_table.clear();
+    result.default_reduction.clear();
+    result.state_origin.clear();
+    for (std::size_t state = 0; state < work.action.size(); ++state) {
+        if (!reachable[state]) {
+            continue;
+        }
+        for (int code : work.action[state]) {
+            result.action.push_back(code > 0 && code != ParseTables::kErrorAction ? newNumber[code] : code);
+        }
+        for (int target : work.gotos[state]) {
+            result.goto_table.push_back(target != -1 ? newNumber[target] : -1);
+        }
+        result.default_reduction.push_back(work.default_reduction[state]);
+        result.state_origin.push_back(work.origin[state]);
+    }
+
+    local.removed_states = static_cast<int>(work.action.size()) - count;
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    return result;
+}
+
+} // namespace seuyacc
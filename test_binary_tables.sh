@@ -0,0 +1,223 @@
+#!/usr/bin/env bash
+# test_binary_tables.sh - 比较通用驱动加载二进制分析表的解析结果与生成的解析器是否一致
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_binary_tables_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+cd "$build_dir"
+
+echo "=== 二进制分析表测试 ==="
+echo ""
+
+cat > calc.y << 'EOF'
+%{
+#include <stdio.h>
+void yyerror(const char* s);
+int yylex(void);
+%}
+%union {
+    int ival;
+}
+%token <ival> NUM
+%type <ival> expr
+%left '+' '-'
+%left '*' '/'
+%start input
+%%
+input : expr ';' { printf("= %d\n", $1); }
+      ;
+expr : expr '+' expr { $$ = $1 + $3; }
+     | expr '-' expr { $$ = $1 - $3; }
+     | expr '*' expr { $$ = $1 * $3; }
+     | expr '/' expr { $$ = $3 ? $1 / $3 : 0; }
+     | '(' expr ')' { $$ = $2; }
+     | NUM
+     ;
+%%
+EOF
+
+cat > lex.c << 'EOF'
+#include <ctype.h>
+#include <stdio.h>
+#include "calc.tab.h"
+
+int yylex(void)
+{
+    int c;
+    do {
+        c = getchar();
+    } while (c == ' ' || c == '\n' || c == '\t');
+    if (c == EOF) {
+        return 0;
+    }
+    if (isdigit(c)) {
+        int n = 0;
+        for (; isdigit(c); c = getchar()) {
+            n = n * 10 + (c - '0');
+        }
+        ungetc(c, stdin);
+        yylval.ival = n;
+        return NUM;
+    }
+    return c;
+}
+EOF
+
+cat > generated_main.c << 'EOF'
+#include <stdio.h>
+#include "calc.tab.h"
+
+char* yytext = "";
+int yylineno = 1;
+void yyerror(const char* s) { (void)s; }
+
+int main(void)
+{
+    printf("status %d\n", yyparse());
+    return 0;
+}
+EOF
+
+# 规则号与 calc.y 中产生式的顺序一致，规则 0 为增广产生式
+cat > runtime_main.c << 'EOF'
+#include <stdio.h>
+#include <string.h>
+#include "calc.tab.h"
+#include "seuyacc_runtime.h"
+
+YYSTYPE yylval;
+
+static int lex(void* user, void* value)
+{
+    int token = yylex();
+    (void)user;
+    memcpy(value, &yylval, sizeof(YYSTYPE));
+    return token;
+}
+
+static int action(void* user, int rule, void* result, void* values, int length)
+{
+    YYSTYPE* v = (YYSTYPE*)values - 1; /* v[1] 即 $1 */
+    YYSTYPE* r = result;
+    (void)user;
+    (void)length;
+    switch (rule) {
+    case 1: printf("= %d\n", v[1].ival); break;
+    case 2: r->ival = v[1].ival + v[3].ival; break;
+    case 3: r->ival = v[1].ival - v[3].ival; break;
+    case 4: r->ival = v[1].ival * v[3].ival; break;
+    case 5: r->ival = v[3].ival ? v[1].ival / v[3].ival : 0; break;
+    case 6: r->ival = v[2].ival; break;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    seuyacc_tables* tables;
+    seuyacc_callbacks callbacks = { sizeof(YYSTYPE), NULL, lex, action, NULL };
+    int status = seuyacc_tables_open(argc > 1 ? argv[1] : "calc.tables", &tables);
+    if (status != SEUYACC_TABLES_OK) {
+        printf("open %d\n", status);
+        return 0;
+    }
+    printf("status %d\n", seuyacc_parse(tables, &callbacks));
+    seuyacc_tables_close(tables);
+    return 0;
+}
+EOF
+
+# 改写表文件中的一个取值: corrupt <输入> <输出> <table|defact|r1|r2> <值>
+# table 改写第一个可被查到（check 非负）的槽，其余段改写下标为 1 的元素（规则 0 是增广产生式）
+cat > corrupt.c << 'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "seuyacc/table_format.h"
+
+int main(int argc, char** argv)
+{
+    static char data[1 << 20];
+    seuyacc_table_header header;
+    FILE* in = fopen(argv[1], "rb");
+    size_t size = fread(data, 1, sizeof(data), in);
+    int32_t value = atoi(argv[4]);
+    uint32_t index = 1;
+    int section = SEUYACC_SEC_TABLE;
+    FILE* out;
+    fclose(in);
+    memcpy(&header, data, sizeof(header));
+    if (strcmp(argv[3], "defact") == 0) {
+        section = SEUYACC_SEC_DEFACT;
+    } else if (strcmp(argv[3], "r1") == 0) {
+        section = SEUYACC_SEC_R1;
+    } else if (strcmp(argv[3], "r2") == 0) {
+        section = SEUYACC_SEC_R2;
+    } else {
+        int32_t check;
+        for (index = 0;; index++) {
+            memcpy(&check, data + header.sections[SEUYACC_SEC_CHECK].offset + index * 4, 4);
+            if (check >= 0) {
+                break;
+            }
+        }
+    }
+    memcpy(data + header.sections[section].offset + index * 4, &value, 4);
+    out = fopen(argv[2], "wb");
+    fwrite(data, 1, size, out);
+    fclose(out);
+    return 0;
+}
+EOF
+
+"$seuyacc" --definitions --binary-tables calc.y > seuyacc.log 2>&1 || { cat seuyacc.log; exit 1; }
+cc -w -I. calc.tab.c lex.c generated_main.c -o generated
+cc -w -I. -I"$root_dir/include" -I"$root_dir/runtime" runtime_main.c lex.c "$root_dir/runtime/seuyacc_runtime.c" -o runtime
+cc -w -I"$root_dir/include" corrupt.c -o corrupt
+
+failed=0
+inputs=("1+2*3;" "(1+2)*3;" "8/2-1;" "2*(3+4)*5-6/2;" "1+;" "((4);" "7;;" "")
+for input in "${inputs[@]}"; do
+    expected=$(printf '%s' "$input" | ./generated | grep -a '^= \|^status')
+    actual=$(printf '%s' "$input" | ./runtime | grep -a '^= \|^status')
+    if [[ "$expected" == "$actual" ]]; then
+        echo "✓ \"$input\""
+    else
+        echo "✗ \"$input\": 期望 $(echo $expected), 实际 $(echo $actual)"
+        failed=1
+    fi
+done
+
+echo ""
+echo "损坏的表文件应被拒绝:"
+head -c 100 calc.tables > truncated.tables
+cp calc.tables bad_version.tables
+printf '\x7f' | dd of=bad_version.tables bs=1 seek=8 conv=notrunc 2> /dev/null
+# 段的范围合法但取值越界: 移入/GOTO 的目标状态、默认规约、规则左部、右部长度
+./corrupt calc.tables bad_target.tables table 100000
+./corrupt calc.tables bad_defact.tables defact 100000
+./corrupt calc.tables bad_lhs.tables r1 0
+./corrupt calc.tables bad_length.tables r2 -3
+for file in truncated.tables bad_version.tables missing.tables bad_target.tables bad_defact.tables bad_lhs.tables \
+    bad_length.tables; do
+    if ./runtime "$file" < /dev/null | grep -q '^open '; then
+        echo "✓ $file"
+    else
+        echo "✗ $file 未被拒绝"
+        failed=1
+    fi
+done
+
+echo ""
+if [[ $failed -eq 0 ]]; then
+    echo "=== 通用驱动与生成的解析器结果一致 ==="
+else
+    echo "=== 测试失败 ==="
+fi
+echo "构建目录: $build_dir"
+exit $failed
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+# test_output_files.sh - 生成或写入失败时已有的输出文件保持不变
+#
+# 输出先写入 <文件>.tmp，全部写完后才替换目标文件；失败时删除临时文件。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_output_files_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+cd "$build_dir"
+cp "$root_dir/examples/c99.y" .
+
+echo "=== 输出文件替换测试 ==="
+echo ""
+
+failed=0
+"$seuyacc" --definitions c99.y > first.log 2>&1 || { cat first.log; exit 1; }
+cp c99.tab.c expected.c
+cp c99.tab.h expected.h
+
+# 检查上一次失败的生成: 退出码非零、原有输出不变、没有留下临时文件
+check_failure() {
+    local description=$1
+    local status=$2
+    local leftover
+    leftover=$(find . -maxdepth 1 -name '*.tmp' -type f)
+    if [[ $status -ne 0 ]] && cmp -s c99.tab.c expected.c && cmp -s c99.tab.h expected.h && [[ -z "$leftover" ]]; then
+        echo "✓ $description"
+    else
+        echo "✗ $description: 退出码 $status, 临时文件 [$leftover]"
+        failed=1
+    fi
+}
+
+# 其中一个输出无法创建时不写任何输出
+mkdir c99.tab.h.tmp
+status=0
+"$seuyacc" --definitions --tables=dense c99.y > open.log 2>&1 || status=$?
+check_failure "无法创建其中一个输出" $status
+rmdir c99.tab.h.tmp
+
+# 写到一半失败 (超过文件大小限制) 时其余已写完的输出也不替换
+status=0
+(
+    trap '' XFSZ
+    ulimit -f 64
+    "$seuyacc" --definitions --tables=dense c99.y
+) > write.log 2>&1 || status=$?
+check_failure "写入解析器代码时失败" $status
+
+# 成功时替换全部输出
+if "$seuyacc" --definitions --tables=dense c99.y > last.log 2>&1 && ! cmp -s c99.tab.c expected.c \
+    && [[ -z "$(find . -maxdepth 1 -name '*.tmp')" ]]; then
+    echo "✓ 生成成功后替换输出"
+else
+    echo "✗ 生成成功后替换输出"
+    failed=1
+fi
+
+echo ""
+if [[ $failed -eq 0 ]]; then
+    echo "=== 失败时原有输出保持不变 ==="
+else
+    echo "=== 测试失败 ==="
+fi
+echo "构建目录: $build_dir"
+exit $failed
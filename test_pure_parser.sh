@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# test_pure_parser.sh - 在多个线程中同时使用可重入解析器 (%define api.pure)
+#
+# 每个线程持有一个 yyparse_ctx，在两次解析之间调用 yyparse_ctx_reset 复用它，
+# 检查每个表达式的计算结果以及错误输入收集到的错误数。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_pure_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+threads=${THREADS:-8}
+parses=${PARSES:-20000}
+
+cd "$build_dir"
+cp "$root_dir/examples/calc_pure.y" .
+
+cat > driver.c << 'EOF'
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calc_pure.tab.h"
+
+typedef struct calc_input {
+    const char* text;
+    int position;
+    long result;
+} calc_input;
+
+typedef struct calc_case {
+    const char* text;
+    long result;
+    int status; /* yyparse 的返回值 */
+} calc_case;
+
+static const calc_case cases[] = {
+    { "1 + 2 * 3", 7, 0 },
+    { "(1 + 2) * 3", 9, 0 },
+    { "100 / 7 - 4", 10, 0 },
+    { "2 * (3 + 4) * (5 - 1)", 56, 0 },
+    { "1 +\n2 +\n3", 6, 0 },
+    { "((((((42))))))", 42, 0 },
+    { "1 + * 2", 0, 1 },
+    { "(1 + 2", 0, 1 },
+};
+#define CASE_COUNT ((int) (sizeof(cases) / sizeof(cases[0])))
+
+static int parses;
+
+static void* worker(void* arg)
+{
+    int id = (int) (long) arg;
+    int failures = 0;
+    calc_input input;
+    yyparse_ctx ctx;
+    yyparse_ctx_init(&ctx, &input);
+    for (int i = 0; i < parses; i++) {
+        const calc_case* c = &cases[(i + id) % CASE_COUNT];
+        input.text = c->text;
+        input.position = 0;
+        input.result = 0;
+        yyparse_ctx_reset(&ctx);
+        int status = yyparse(&ctx);
+        if (status != c->status || (status == 0 && input.result != c->result)
+            || ctx.error_count != (c->status != 0)) {
+            if (failures++ == 0) {
+                fprintf(stderr, "线程 %d: \"%s\" 返回 %d, 结果 %ld, 错误 %d\n", id, c->text, status, input.result,
+                    ctx.error_count);
+            }
+        }
+    }
+    if (id == 0) {
+        /* 最后一个用例有语法错误，输出收集到的错误 */
+        input.text = cases[CASE_COUNT - 1].text;
+        input.position = 0;
+        yyparse_ctx_reset(&ctx);
+        yyparse(&ctx);
+        yyparse_ctx_print_errors(&ctx, stdout);
+    }
+    yyparse_ctx_destroy(&ctx);
+    return (void*) (long) failures;
+}
+
+int main(int argc, char** argv)
+{
+    int threads = argc > 1 ? atoi(argv[1]) : 8;
+    parses = argc > 2 ? atoi(argv[2]) : 20000;
+    pthread_t* ids = malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&ids[i], NULL, worker, (void*) (long) i);
+    }
+    long failures = 0;
+    for (int i = 0; i < threads; i++) {
+        void* result;
+        pthread_join(ids[i], &result);
+        failures += (long) result;
+    }
+    free(ids);
+    printf("%d 个线程 x %d 次解析, 失败 %ld 次\n", threads, parses, failures);
+    return failures == 0 ? 0 : 1;
+}
+EOF
+
+echo "=== 可重入解析器并发测试 ==="
+"$seuyacc" --definitions calc_pure.y > seuyacc.log 2>&1
+cc -Wall -O2 -I. -c calc_pure.tab.c -o calc_pure.tab.o
+cc -Wall -O2 -I. -c driver.c -o driver.o
+cc calc_pure.tab.o driver.o -o calc_pure -lpthread
+
+if ./calc_pure "$threads" "$parses" 2> errors.log; then
+    echo "✓ 通过"
+else
+    echo "✗ 失败"
+    cat errors.log
+    exit 1
+fi
+
+# 不合法的 %define api.pure 值应使生成失败，而不是生成使用全局状态的解析器
+sed 's/^%define api.pure.*/%define api.pure bogus/' calc_pure.y > bad_pure.y
+if "$seuyacc" bad_pure.y > bad_pure.log 2>&1 || [[ -e bad_pure.tab.c ]]; then
+    echo "✗ %define api.pure bogus 未被拒绝"
+    exit 1
+fi
+echo "✓ 拒绝不合法的 %define api.pure 值"
+echo "构建目录: $build_dir"
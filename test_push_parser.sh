@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+# test_push_parser.sh - 在一个线程中交替推进多个推送式解析 (%define api.push-pull both)
+#
+# 为每个表达式创建一个 yypstate，按轮转顺序每次只向其中一个推送一个 token，
+# 检查结果与逐个调用 yyparse 时一致。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_push_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+streams=${STREAMS:-10000}
+
+cd "$build_dir"
+sed 's/^%define api.pure full$/%define api.pure full\n%define api.push-pull both/' "$root_dir/examples/calc_pure.y" > calc_push.y
+
+cat > driver.c << 'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calc_push.tab.h"
+
+typedef struct calc_input {
+    const char* text;
+    int position;
+    long result;
+} calc_input;
+
+static const char* texts[] = {
+    "1 + 2 * 3",
+    "(1 + 2) * 3",
+    "100 / 7 - 4",
+    "2 * (3 + 4) * (5 - 1)",
+    "((((((42))))))",
+    "1 + * 2",
+};
+#define TEXT_COUNT ((int) (sizeof(texts) / sizeof(texts[0])))
+
+/* 一路输入：自己的词法位置、上下文与推送式解析状态 */
+typedef struct stream {
+    calc_input input;
+    yyparse_ctx ctx;
+    yypstate* ps;
+    int status;
+} stream;
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    stream* streams = calloc(count, sizeof(stream));
+    for (int i = 0; i < count; i++) {
+        streams[i].input.text = texts[i % TEXT_COUNT];
+        yyparse_ctx_init(&streams[i].ctx, &streams[i].input);
+        streams[i].ps = yypstate_new(&streams[i].ctx);
+        streams[i].status = YYPUSH_MORE;
+    }
+
+    /* 轮转推进：每一轮给每个未结束的解析推送一个 token */
+    int active = count;
+    while (active > 0) {
+        for (int i = 0; i < count; i++) {
+            stream* s = &streams[i];
+            if (s->status != YYPUSH_MORE) {
+                continue;
+            }
+            YYSTYPE value;
+            int token = yylex(&value, &s->ctx);
+            s->status = yypush_parse(s->ps, token, &value);
+            if (s->status != YYPUSH_MORE) {
+                active--;
+            }
+        }
+    }
+
+    /* 与拉取式的 yyparse 对照 */
+    int failures = 0;
+    for (int i = 0; i < count; i++) {
+        calc_input input = { texts[i % TEXT_COUNT], 0, 0 };
+        yyparse_ctx ctx;
+        yyparse_ctx_init(&ctx, &input);
+        int status = yyparse(&ctx);
+        if (status != streams[i].status || input.result != streams[i].input.result
+            || ctx.error_count != streams[i].ctx.error_count) {
+            if (failures++ == 0) {
+                fprintf(stderr, "\"%s\": 推送式返回 %d 结果 %ld, 拉取式返回 %d 结果 %ld\n", input.text,
+                    streams[i].status, streams[i].input.result, status, input.result);
+            }
+        }
+        yyparse_ctx_destroy(&ctx);
+        yypstate_delete(streams[i].ps);
+        yyparse_ctx_destroy(&streams[i].ctx);
+    }
+    free(streams);
+    printf("%d 路交替解析, 不一致 %d 路\n", count, failures);
+    return failures == 0 ? 0 : 1;
+}
+EOF
+
+echo "=== 推送式解析器测试 ==="
+"$seuyacc" --definitions calc_push.y > seuyacc.log 2>&1
+cc -Wall -O2 -I. -c calc_push.tab.c -o calc_push.tab.o
+cc -Wall -O2 -I. -c driver.c -o driver.o
+cc calc_push.tab.o driver.o -o calc_push
+
+if ./calc_push "$streams" 2> errors.log; then
+    echo "✓ 通过"
+else
+    echo "✗ 失败"
+    cat errors.log
+    exit 1
+fi
+
+# 不合法的 %define api.push-pull 值应使生成失败，而不是只生成拉取式解析器
+sed 's/^%define api.push-pull.*/%define api.push-pull sideways/' calc_push.y > bad_push.y
+if "$seuyacc" bad_push.y > bad_push.log 2>&1 || [[ -e bad_push.tab.c ]]; then
+    echo "✗ %define api.push-pull sideways 未被拒绝"
+    exit 1
+fi
+echo "✓ 拒绝不合法的 %define api.push-pull 值"
+echo "构建目录: $build_dir"
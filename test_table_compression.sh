@@ -0,0 +1,102 @@
+#!/usr/bin/env bash
+# test_table_compression.sh - 比较稠密分析表与压缩分析表生成的解析器是否等价
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_table_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+modes=(dense comb rows color)
+failed=0
+
+echo "=== 分析表压缩等价性测试 ==="
+echo ""
+
+echo "步骤 1: 逐项校验压缩表..."
+for grammar in "$root_dir"/examples/*.y; do
+    name=$(basename "$grammar" .y)
+    mkdir -p "$build_dir/verify"
+    cp "$grammar" "$build_dir/verify/"
+    for mode in "${modes[@]}"; do
+        log="$build_dir/verify/$name.$mode.log"
+        if "$seuyacc" --tables="$mode" --verify-tables "$build_dir/verify/$name.y" > "$log" 2>&1; then
+            echo "✓ $name.y ($mode)"
+        else
+            echo "✗ $name.y ($mode, 详见 $log)"
+            failed=1
+        fi
+    done
+    log="$build_dir/verify/$name.unit.log"
+    if "$seuyacc" --eliminate-unit-rules --verify-tables "$build_dir/verify/$name.y" > "$log" 2>&1; then
+        echo "✓ $name.y (消除单元规约)"
+    else
+        echo "✗ $name.y (消除单元规约, 详见 $log)"
+        failed=1
+    fi
+done
+
+if ! command -v lex &> /dev/null; then
+    echo ""
+    echo "未找到 lex，跳过运行时比较"
+    exit $failed
+fi
+
+echo ""
+echo "步骤 2: 用各种表存储方式生成并编译解析器..."
+for grammar in "$root_dir"/examples/*.y; do
+    name=$(basename "$grammar" .y)
+    [[ -f "$root_dir/examples/$name.l" ]] || continue
+
+    for mode in "${modes[@]}"; do
+        dir="$build_dir/$mode/$name"
+        mkdir -p "$dir"
+        cp "$grammar" "$root_dir/examples/$name.l" "$dir/"
+        (
+            cd "$dir"
+            "$seuyacc" --definitions --tables="$mode" "$name.y" > seuyacc.log 2>&1
+            lex -o "${name}_lex.yy.c" "$name.l"
+            cc -I. "$name.tab.c" "${name}_lex.yy.c" -ll -o parser 2>/dev/null || \
+                cc -I. "$name.tab.c" "${name}_lex.yy.c" -lfl -o parser 2>/dev/null || \
+                c++ -I. "$name.tab.c" "${name}_lex.yy.c" -o parser 2>/dev/null
+        ) || { echo "✗ $name ($mode) 生成或编译失败"; failed=1; }
+    done
+done
+
+echo ""
+echo "步骤 3: 在所有示例输入上比较解析结果..."
+for grammar in "$root_dir"/examples/*.y; do
+    name=$(basename "$grammar" .y)
+    [[ -x "$build_dir/dense/$name/parser" ]] || continue
+
+    for input in "$root_dir"/examples/*.c; do
+        reference=""
+        for mode in "${modes[@]}"; do
+            dir="$build_dir/$mode/$name"
+            [[ -x "$dir/parser" ]] || continue
+            rm -f "$dir/output.asm"
+            status=0
+            (cd "$dir" && timeout 10 ./parser < "$input" > run.log 2>&1) || status=$?
+            # 解析过程的跟踪输出会打印表项编码，只比较退出码、错误报告与生成的汇编
+            result="$status $(grep -a -A1000 '"errors"' "$dir/run.log" || true) $(cat "$dir/output.asm" 2> /dev/null || true)"
+            if [[ -z "$reference" ]]; then
+                reference="$result"
+            elif [[ "$result" != "$reference" ]]; then
+                echo "✗ $name / $(basename "$input"): $mode 与 ${modes[0]} 的结果不同"
+                failed=1
+            fi
+        done
+    done
+    echo "✓ $name 比较完成"
+done
+
+echo ""
+if [[ $failed -eq 0 ]]; then
+    echo "=== 所有分析表存储方式结果一致 ==="
+else
+    echo "=== 测试失败 ==="
+fi
+echo "构建目录: $build_dir"
+exit $failed
@@ -0,0 +1,124 @@
+#!/usr/bin/env bash
+# test_unit_rules.sh - 比较消除单元规约前后生成的解析器的计算结果
+#
+# num: INT { $$ = $1; } 把 <ival> 转换为 <dval>，不能当作单元规约消除；
+# expr: num 的左右两边类型相同，消除后结果不变。
+# 二进制表的语义动作由宿主按规则号回调，消除单元规约只用于生成的C解析器，二进制表不变。
+
+set -euo pipefail
+
+root_dir=$(cd "$(dirname "$0")" && pwd)
+build_dir="$root_dir/build_unit_rules_test"
+rm -rf "$build_dir"
+mkdir -p "$build_dir"
+
+seuyacc="$root_dir/seuyacc"
+cd "$build_dir"
+
+echo "=== 单元规约消除测试 ==="
+echo ""
+
+cat > calc.y << 'EOF'
+%{
+#include <stdio.h>
+void yyerror(const char* s);
+int yylex(void);
+%}
+%union {
+    int ival;
+    double dval;
+}
+%token <ival> INT
+%type <dval> expr num
+%start input
+%%
+input : expr ';' { printf("= %g\n", $1); }
+      ;
+expr : expr '+' num { $$ = $1 + $3; }
+     | num
+     ;
+num : INT { $$ = $1; }
+    ;
+%%
+EOF
+
+cat > main.c << 'EOF'
+#include <ctype.h>
+#include <stdio.h>
+#include "calc.tab.h"
+
+char* yytext = "";
+int yylineno = 1;
+void yyerror(const char* s) { (void)s; }
+
+int yylex(void)
+{
+    int c;
+    do {
+        c = getchar();
+    } while (c == ' ' || c == '\n' || c == '\t');
+    if (c == EOF) {
+        return 0;
+    }
+    if (isdigit(c)) {
+        int n = 0;
+        for (; isdigit(c); c = getchar()) {
+            n = n * 10 + (c - '0');
+        }
+        ungetc(c, stdin);
+        yylval.ival = n;
+        return INT;
+    }
+    return c;
+}
+
+int main(void)
+{
+    printf("status %d\n", yyparse());
+    return 0;
+}
+EOF
+
+failed=0
+for variant in plain unit; do
+    mkdir -p "$variant"
+    cp calc.y main.c "$variant/"
+    flags=()
+    [[ "$variant" == unit ]] && flags=(--eliminate-unit-rules)
+    (
+        cd "$variant"
+        "$seuyacc" --definitions --binary-tables "${flags[@]}" calc.y > seuyacc.log 2>&1
+        cc -w -I. calc.tab.c main.c -o parser
+    ) || { echo "✗ $variant 生成或编译失败 (详见 $build_dir/$variant/seuyacc.log)"; exit 1; }
+done
+
+inputs=("1+2;" "40+1+1;" "7;" "1+;")
+expected_results=("= 3" "= 42" "= 7" "")
+for i in "${!inputs[@]}"; do
+    input=${inputs[$i]}
+    plain=$(printf '%s' "$input" | ./plain/parser | grep -a '^= \|^status')
+    unit=$(printf '%s' "$input" | ./unit/parser | grep -a '^= \|^status')
+    value=$(echo "$plain" | grep -a '^= ' || true)
+    if [[ "$plain" == "$unit" && "$value" == "${expected_results[$i]}" ]]; then
+        echo "✓ \"$input\""
+    else
+        echo "✗ \"$input\": 未消除 $(echo $plain), 消除后 $(echo $unit)"
+        failed=1
+    fi
+done
+
+if cmp -s plain/calc.tables unit/calc.tables; then
+    echo "✓ 二进制表不受 --eliminate-unit-rules 影响"
+else
+    echo "✗ 二进制表中的单元规约被消除，宿主的回调不会被调用"
+    failed=1
+fi
+
+echo ""
+if [[ $failed -eq 0 ]]; then
+    echo "=== 消除单元规约前后结果一致 ==="
+else
+    echo "=== 测试失败 ==="
+fi
+echo "构建目录: $build_dir"
+exit $failed
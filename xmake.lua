@@ -1,11 +1,34 @@
 add_rules("mode.debug", "mode.release")
 
 add_rules("plugin.compile_commands.autoupdate", {outputdir = ".vscode"})
+-- 生成器库：提供内存接口，可通过 xmake f -k shared 构建为动态库
+target("libseuyacc")
+    set_kind("$(kind)")
+    set_basename("seuyacc")
+    set_languages("c++17")
+    add_includedirs("include", {public = true})
+    add_headerfiles("include/(seuyacc/*.h)")
+    add_files("src/*.cpp|main.cpp")
+    if is_kind("shared") then
+        add_rules("utils.symbols.export_all", {export_classes = true})
+    end
+
+-- 通用驱动：加载 seuyacc -b 生成的二进制分析表进行解析
+target("seuyacc_runtime")
+    set_kind("static")
+    set_languages("c99")
+    add_includedirs("include", "runtime", {public = true})
+    add_headerfiles("runtime/seuyacc_runtime.h", "runtime/seuyacc_parser.hpp", "include/(seuyacc/table_format.h)")
+    add_files("runtime/*.c")
+
 target("seuyacc")
     set_kind("binary")
     set_languages("c++17")
-    add_includedirs("include")
-    add_files("src/*.cpp")
+    add_deps("libseuyacc")
+    add_files("src/main.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
 
     after_build(function (target)
         import("core.project.config")